@@ -2,6 +2,7 @@
 #include "clients_func.h"
 #include <QMessageBox>
 #include <QCryptographicHash>
+#include <QTimer>
 
 extern QApplication a;
 
@@ -12,6 +13,7 @@ QTcpSocket* SingletonDestroyer::socket = nullptr;
 QTcpSocket* Client::socket = nullptr;
 SingletonDestroyer Client::el = SingletonDestroyer();
 int Client::port = 8080;
+int Client::handshake_timeout = 2000;
 
 /**
  * @brief Инициализирует разрушитель синглтона
@@ -76,24 +78,85 @@ Client* Client::get_instance() {
 
 /**
  * @brief Обработчик успешного подключения к серверу
+ *
+ * Предлагает серверу протокол v2. Если сервер не ответил за
+ * handshake_timeout мс, используется прежний текстовый формат
  */
 void Client::connect_to_server() {
     // Настраиваем обработку входящих данных
     connect(this->socket, &QTcpSocket::readyRead, this, &Client::read);
+
+    this->protocol = protocol_mode::UNKNOWN;
+    this->negotiation.clear();
+    this->incoming.clear();
+    this->socket->write(frame_buffer::handshake);
+    QTimer::singleShot(handshake_timeout, this, [this]() {
+        if (this->protocol == protocol_mode::UNKNOWN)
+            this->finish_negotiation(protocol_mode::LEGACY);
+    });
+}
+
+/**
+ * @brief Завершает согласование протокола
+ * @param mode Выбранная версия протокола
+ */
+void Client::finish_negotiation(protocol_mode mode) {
+    this->protocol = mode;
+    this->negotiation.clear();
+    for (const QByteArray& data : this->pending) {
+        this->send(data);
+    }
+    this->pending.clear();
 }
 
 /**
  * @brief Читает данные от сервера
  *
- * Обрабатывает входящие сообщения и генерирует соответствующие сигналы
+ * В протоколе v2 за одно чтение обрабатываются все полностью принятые
+ * кадры, неполный кадр дожидается следующего чтения
  */
 void Client::read() {
-    QByteArray data;
-    while (this->socket->bytesAvailable() > 0) {
-        data.append(this->socket->readAll());
+    QByteArray data = this->socket->readAll();
+
+    // Ожидание ответа на согласование протокола
+    if (this->protocol == protocol_mode::UNKNOWN) {
+        this->negotiation.append(data);
+        if (this->negotiation.startsWith(frame_buffer::handshake)) {
+            data = this->negotiation.mid(frame_buffer::handshake.size());
+            this->finish_negotiation(protocol_mode::FRAMED);
+        }
+        else if (frame_buffer::handshake.startsWith(this->negotiation)) {
+            return;
+        }
+        else {
+            data = this->negotiation;
+            this->finish_negotiation(protocol_mode::LEGACY);
+        }
     }
-    QString data_to_qstring = QString(data);
 
+    if (this->protocol == protocol_mode::LEGACY) {
+        this->handle_message(QString(data));
+        return;
+    }
+
+    this->incoming.append(data);
+    QByteArray frame;
+    while (this->incoming.next(frame)) {
+        this->handle_message(QString::fromUtf8(frame));
+    }
+    if (this->incoming.is_broken()) {
+        qDebug() << QString("%1 Сервер прислал кадр недопустимого размера").arg(clients_func::get_client_time());
+        this->socket->disconnectFromHost();
+    }
+}
+
+/**
+ * @brief Обрабатывает одно сообщение сервера
+ * @param data_to_qstring Сообщение в формате "action|payload"
+ *
+ * Генерирует сигналы, соответствующие ответу сервера
+ */
+void Client::handle_message(const QString& data_to_qstring) {
     // Обработка сообщений о регистрации
     if (data_to_qstring == "register|ok")
         emit this->register_ok();
@@ -110,9 +173,16 @@ void Client::read() {
     if (data_to_qstring == "reset|error")
         emit this->reset_error();
 
+    QStringList parts = data_to_qstring.split("|");
+
+    // Отказ в подключении: сервер перегружен и закрывает соединение
+    if (parts[0] == "busy") {
+        clients_func::create_messagebox("Ошибка", parts.size() >= 2 ? parts[1] : "Сервер перегружен, повторите попытку позже");
+    }
+
     // Обработка ответов на уравнения
-    if (data_to_qstring.split("|")[0] == "answer") {
-        QString answer = data_to_qstring.split("|")[1];
+    if (parts[0] == "answer" && parts.size() >= 2) {
+        QString answer = parts[1];
         if (answer != "error" and answer != "infinity_solutions" and answer != "no_solution")
             emit this->equation_ok(answer);
         else
@@ -126,6 +196,8 @@ void Client::read() {
  * @brief Отправляет сообщение серверу
  * @param text Текст сообщения
  * @return true если сообщение отправлено успешно, false в случае ошибки
+ *
+ * До завершения согласования протокола сообщения откладываются
  */
 bool Client::write(QString text) {
     QByteArray data = text.toUtf8();
@@ -133,12 +205,27 @@ bool Client::write(QString text) {
         clients_func::create_messagebox("Ошибка", "Нет подключения к серверу, попробуйте перезапустить приложение");
         return false;
     }
+    else if (this->protocol == protocol_mode::UNKNOWN) {
+        this->pending.append(data);
+        return true;
+    }
     else {
-        this->socket->write(data);
+        this->send(data);
         return true;
     }
 }
 
+/**
+ * @brief Отправляет сообщение в согласованном формате
+ * @param data Сообщение в формате "action|payload"
+ */
+void Client::send(const QByteArray& data) {
+    if (this->protocol == protocol_mode::FRAMED)
+        this->socket->write(frame_buffer::pack(data));
+    else
+        this->socket->write(data);
+}
+
 /**
  * @brief Обработчик отключения от сервера
  */
@@ -5,6 +5,8 @@
 #include <QByteArray>
 #include <QObject>
 #include <QString>
+#include <QList>
+#include "frame_buffer.h"
 
 // Предварительное объявление класса Client
 class Client;
@@ -70,6 +72,12 @@ private:
     static QTcpSocket* socket;    ///< Сокет для соединения с сервером
     static Client* p_instance;    ///< Единственный экземпляр клиента
     static int port;             ///< Порт для подключения
+    static int handshake_timeout; ///< Время ожидания ответа на согласование протокола (мс)
+
+    protocol_mode protocol = protocol_mode::UNKNOWN; ///< Согласованная версия протокола
+    QByteArray negotiation;       ///< Начало ответа сервера до завершения согласования
+    frame_buffer incoming;        ///< Буфер сборки кадров протокола v2
+    QList<QByteArray> pending;    ///< Сообщения, отправленные до завершения согласования
 
     /**
      * @brief Приватный конструктор
@@ -78,6 +86,24 @@ private:
 
     static SingletonDestroyer el; ///< Объект-разрушитель для управления временем жизни
 
+    /**
+     * @brief Обрабатывает одно сообщение сервера
+     * @param message Сообщение в формате "action|payload"
+     */
+    void handle_message(const QString& message);
+
+    /**
+     * @brief Завершает согласование протокола и отправляет отложенные сообщения
+     * @param mode Выбранная версия протокола
+     */
+    void finish_negotiation(protocol_mode mode);
+
+    /**
+     * @brief Отправляет сообщение в согласованном формате
+     * @param data Сообщение в формате "action|payload"
+     */
+    void send(const QByteArray& data);
+
 private slots:
     /**
      * @brief Устанавливает соединение с сервером
@@ -28,6 +28,7 @@ SOURCES += \
     $$PWD/src/client.cpp \
     $$PWD/src/client_main_window.cpp \
     $$PWD/src/clients_func.cpp \
+    $$PWD/src/frame_buffer.cpp \
     $$PWD/src/main.cpp \
     $$PWD/src/notification.cpp \
     $$PWD/src/reg_form.cpp \
@@ -38,6 +39,7 @@ HEADERS += \
     $$PWD/include/client.h \
     $$PWD/include/client_main_window.h \
     $$PWD/include/clients_func.h \
+    $$PWD/include/frame_buffer.h \
     $$PWD/include/notification.h \
     $$PWD/include/reg_form.h \
     $$PWD/include/reset_password.h
@@ -2,17 +2,23 @@
 #include "../include/functions_for_server.h"
 #include <QList>
 #include <QByteArray>
-#include "../include/dbsingleton.h"
+#include <QMutex>
+#include <QMutexLocker>
 
 extern QList<client*> clients;              ///< Глобальный список подключенных клиентов
 extern functions_for_server* servers_functions; ///< Глобальный экземпляр функций сервера
 
+/// Клиенты создаются и удаляются в разных потоках ввода-вывода
+static QMutex clients_mutex;
+
 /**
  * @brief Конструктор класса client
  * @param client_description Дескриптор сокета клиента
+ * @param timeouts Тайм-ауты соединения
  * @param parent Родительский QObject
  */
-client::client(qintptr client_description, QObject* parent): QObject(parent), client_description(client_description)
+client::client(qintptr client_description, const connection_timeouts& timeouts, QObject* parent)
+    : QObject(parent), client_description(client_description), timeouts(timeouts)
 {
     initialization();
 }
@@ -20,204 +26,256 @@ client::client(qintptr client_description, QObject* parent): QObject(parent), cl
 /**
  * @brief Деструктор класса client
  *
- * Очищает ресурсы клиента, удаляет из глобального списка,
- * закрывает сокет и отправляет сигнал удаления потока
+ * Очищает ресурсы клиента, удаляет из глобального списка
+ * и закрывает сокет
  */
 client::~client() {
     qDebug() << "Деструктор клиента успешно вызван!";
-    clients.removeAll(this);
+    connection_registry::remove(context.connection_id);
     this->client_socket->close();
+    QMutexLocker locker(&clients_mutex);
+    clients.removeAll(this);
     this->bye_message();
-    emit this->del_thread();
 }
 
 /**
  * @brief Инициализация подключения клиента
  *
- * Настраивает сокет, добавляет клиента в глобальный список,
- * устанавливает signal-slot соединения для:
- * - Чтения данных
- * - Регистрации
- * - Авторизации
- * - Сброса пароля
- * - Решения уравнений
+ * Настраивает сокет, добавляет клиента в глобальный список и реестр
+ * соединений, устанавливает signal-slot соединения для чтения данных.
+ * Сообщения разбирает request_dispatcher, ответы на запросы доставляются
+ * через connection_registry::reply по контексту запроса
  */
 void client::initialization() {
     client_socket = new QTcpSocket(this);
     client_socket->setSocketDescriptor(client_description);
-    clients.push_back(this);
-    hello_message();
+    // Пока чтение приостановлено, данные остаются в буфере ядра и TCP сдерживает клиента
+    client_socket->setReadBufferSize(read_buffer_size);
+    context.connection_id = connection_registry::add(this);
+    dispatcher = new request_dispatcher(this);
+    {
+        QMutexLocker locker(&clients_mutex);
+        clients.push_back(this);
+        hello_message();
+    }
 
     // Базовые соединения сокета
     connect(client_socket, &QTcpSocket::readyRead, this, &client::slot_read_from_client);
     connect(client_socket, &QTcpSocket::disconnected, this, &client::slot_close_connection);
+    connect(client_socket, &QTcpSocket::bytesWritten, this, &client::slot_flush_outgoing);
 
-    // Соединения для регистрации
-    connect(this, &client::signal_register_new_account,
-            DBSingleton::getInstance(), &DBSingleton::slot_register_new_account);
-    connect(DBSingleton::getInstance(), &DBSingleton::register_ok,
-            this, &client::slot_register_ok);
-    connect(DBSingleton::getInstance(), &DBSingleton::register_error,
-            this, &client::slot_register_error);
-
-    // Соединения для авторизации
-    connect(this, &client::signal_auth,
-            DBSingleton::getInstance(), &DBSingleton::slot_auth);
-    connect(DBSingleton::getInstance(), &DBSingleton::auth_ok,
-            this, &client::slot_auth_ok);
-    connect(DBSingleton::getInstance(), &DBSingleton::auth_error,
-            this, &client::slot_auth_error);
-
-    // Соединения для сброса пароля
-    connect(this, &client::signal_send_code_to_email,
-            DBSingleton::getInstance(), &DBSingleton::slot_send_code);
-    connect(DBSingleton::getInstance(), &DBSingleton::reset_error,
-            this, &client::slot_reset_error);
-    connect(this, &client::signal_set_new_password,
-            DBSingleton::getInstance(), &DBSingleton::slot_new_password);
-
-    // Соединения для решения уравнений
-    connect(this, &client::signal_linear_equation,
-            servers_functions, &functions_for_server::slot_linear_equation);
-    connect(this, &client::signal_quadratic_equation,
-            servers_functions, &functions_for_server::slot_quadratic_equation);
-    connect(servers_functions, &functions_for_server::signal_equation_solution,
-            this, &client::slot_equation_solution);
+    // Таймер переносится в поток соединения вместе с клиентом
+    watchdog = new QTimer(this);
+    watchdog->setSingleShot(true);
+    connect(watchdog, &QTimer::timeout, this, &client::slot_watchdog_timeout);
+    restart_watchdog();
+}
+
+/**
+ * @brief Передача ответа в поток соединения
+ * @param message Сообщение для отправки
+ *
+ * Запись в сокет выполняется в потоке соединения. Пока удерживается
+ * мьютекс connection_registry, клиент не может быть удалён, а событие,
+ * поставленное в очередь удалённому позже объекту, Qt отбрасывает сам
+ */
+void client::deliver(const QByteArray& message) {
+    QMetaObject::invokeMethod(this, [this, message]() {
+        send(message);
+    }, Qt::QueuedConnection);
 }
 
 /**
  * @brief Обработка входящих данных от клиента
  *
- * Обрабатывает различные действия клиента:
- * - Регистрация ("reg")
- * - Авторизация ("login")
- * - Сброс пароля ("reset", "new_password")
- * - Решение уравнений ("equation")
+ * При первом чтении определяет версию протокола: клиент v2 начинает
+ * поток со строки frame_buffer::handshake. В протоколе v2 байты
+ * накапливаются в буфере, и за одно чтение обрабатываются все полностью
+ * принятые кадры. В текстовом формате всё прочитанное считается одним
+ * сообщением, как и раньше.
+ *
+ * Пока очередь ответов переполнена, данные не читаются
  */
 void client::slot_read_from_client() {
     qDebug() << "Сработал " << Q_FUNC_INFO << " . Текущий поток - " << QThread::currentThreadId();
-    QString data;
-    while (client_socket->bytesAvailable()) {
-        data.push_back(client_socket->readAll());
-    }
-
-    QString action = data.split("|")[0];
-    QString clients_data = data.split("|")[1];
-
-    // Обработка регистрации
-    if (action == "reg") {
-        QStringList clients_data_list = clients_data.split("$");
-        emit signal_register_new_account(
-            clients_data_list[0], // логин
-            clients_data_list[1], // пароль
-            clients_data_list[2], // email
-            clients_data_list[3], // фамилия
-            clients_data_list[4], // имя
-            clients_data_list[5]  // отчество
-            );
-    }
-
-    // Обработка авторизации
-    if (action == "login") {
-        QString login = clients_data.split("$")[0];
-        QString password = clients_data.split("$")[1];
-        emit this->signal_auth(login, password);
-    }
-
-    // Обработка сброса пароля
-    if (action == "reset") {
-        QString email = clients_data.split("$")[0];
-        QString code = clients_data.split("$")[1];
-        emit signal_send_code_to_email(email, code);
-    }
-    if (action == "new_password") {
-        QString login = clients_data.split("$")[0];
-        QString new_password = clients_data.split("$")[1];
-        emit signal_set_new_password(login, new_password);
-    }
-
-    // Обработка решения уравнений
-    if (action == "equation") {
-        QString type_equation = data.split("|")[1];
-        if (type_equation == QString("linear")) {
-            QStringList List_with_koef = data.split("|")[2].split("$");
-            emit this->signal_linear_equation(List_with_koef[0], List_with_koef[1]);
+    if (reading_paused) {
+        return;
+    }
+    QByteArray data = client_socket->readAll();
+
+    // Согласование протокола
+    if (protocol == protocol_mode::UNKNOWN) {
+        negotiation.append(data);
+        if (negotiation.startsWith(frame_buffer::handshake)) {
+            protocol = protocol_mode::FRAMED;
+            data = negotiation.mid(frame_buffer::handshake.size());
+            enqueue(frame_buffer::handshake);
+        }
+        else if (frame_buffer::handshake.startsWith(negotiation)) {
+            restart_watchdog();
+            return; // Строка согласования пришла не полностью
         }
-        if (type_equation == "quadratic") {
-            QStringList List_with_koef = data.split("|")[2].split("$");
-            emit this->signal_quadratic_equation(
-                List_with_koef[0], // a
-                List_with_koef[1], // b
-                List_with_koef[2]  // c
-                );
+        else {
+            protocol = protocol_mode::LEGACY;
+            data = negotiation;
         }
+        negotiation.clear();
+        context.protocol = protocol;
     }
 
-    qDebug() << QString("%1 Клиент ").arg(servers_functions->get_server_time())
-             << &client_socket
-             << QString(" отправил сообщение: %1").arg(QString(data)).simplified();
+    if (protocol == protocol_mode::LEGACY) {
+        dispatcher->dispatch(context, data);
+        restart_watchdog();
+        return;
+    }
+
+    incoming.append(data);
+    QByteArray frame;
+    while (incoming.next(frame)) {
+        dispatcher->dispatch(context, frame);
+    }
+    if (incoming.is_broken()) {
+        qDebug() << QString("%1 Клиент ").arg(servers_functions->get_server_time())
+                 << &client_socket
+                 << " прислал кадр недопустимого размера, соединение закрыто";
+        client_socket->disconnectFromHost();
+        return;
+    }
+    restart_watchdog();
 }
 
 /**
- * @brief Обработка отключения клиента
+ * @brief Отправка сообщения клиенту
+ * @param message Сообщение в формате "action|payload"
+ *
+ * В протоколе v2 сообщение упаковывается в кадр с заголовком длины
  */
-void client::slot_close_connection() {
-    this->client_socket->close();
-    this->deleteLater();
+void client::send(const QByteArray& message) {
+    if (protocol == protocol_mode::FRAMED) {
+        enqueue(frame_buffer::pack(message));
+    } else {
+        enqueue(message);
+    }
 }
 
-/// @name Обработчики ответов
-/// @{
 /**
- * @brief Обработка успешной регистрации
+ * @brief Добавление байтов в очередь ответов
+ * @param bytes Данные для отправки
  */
-void client::slot_register_ok() {
-    this->client_socket->write("register|ok");
+void client::enqueue(const QByteArray& bytes) {
+    outgoing.append(bytes);
+    update_queued();
+    if (!flush_scheduled) {
+        flush_scheduled = true;
+        QMetaObject::invokeMethod(this, &client::slot_flush_outgoing, Qt::QueuedConnection);
+    }
 }
 
 /**
- * @brief Обработка ошибки регистрации
+ * @brief Передача очереди ответов сокету
+ *
+ * Сокету передаётся не больше socket_chunk байт сверх ещё не отправленных,
+ * остальное ждёт в очереди сигнала bytesWritten
  */
-void client::slot_register_error() {
-    this->client_socket->write("register|error");
+void client::slot_flush_outgoing() {
+    flush_scheduled = false;
+    const qint64 pending = outgoing.size() - outgoing_offset;
+    const qint64 room = socket_chunk - client_socket->bytesToWrite();
+    if (pending > 0 && room > 0) {
+        const qint64 length = qMin(pending, room);
+        client_socket->write(outgoing.constData() + outgoing_offset, length);
+        outgoing_offset += int(length);
+    }
+
+    // Переданная часть удаляется целиком или когда она занимает больше половины буфера
+    if (outgoing_offset == outgoing.size()) {
+        outgoing.clear();
+        outgoing_offset = 0;
+    } else if (outgoing_offset > outgoing.size() / 2) {
+        outgoing.remove(0, outgoing_offset);
+        outgoing_offset = 0;
+    }
+    update_queued();
 }
 
 /**
- * @brief Обработка успешной авторизации
+ * @brief Пересчёт объёма очереди и управление чтением
  */
-void client::slot_auth_ok() {
-    this->client_socket->write("auth|ok");
+void client::update_queued() {
+    const qint64 total = outgoing.size() - outgoing_offset + client_socket->bytesToWrite();
+    queued.store(total, std::memory_order_relaxed);
+
+    if (!reading_paused && total > high_water_mark) {
+        reading_paused = true;
+        qDebug() << QString("%1 Клиент ").arg(servers_functions->get_server_time())
+                 << &client_socket
+                 << QString(" не успевает принимать ответы (%1 байт в очереди), чтение приостановлено").arg(total);
+    } else if (reading_paused && total < low_water_mark) {
+        reading_paused = false;
+        qDebug() << QString("%1 Клиент ").arg(servers_functions->get_server_time())
+                 << &client_socket
+                 << QString(" разгрузил очередь ответов (%1 байт), чтение возобновлено").arg(total);
+        if (client_socket->bytesAvailable() > 0) {
+            QMetaObject::invokeMethod(this, &client::slot_read_from_client, Qt::QueuedConnection);
+        }
+    }
 }
 
 /**
- * @brief Обработка ошибки авторизации
+ * @brief Перезапуск таймера соединения
  */
-void client::slot_auth_error() {
-    this->client_socket->write("auth|error");
+void client::restart_watchdog() {
+    const bool partial = protocol == protocol_mode::UNKNOWN ? !negotiation.isEmpty() : incoming.pending() > 0;
+    const int interval = partial ? timeouts.read_ms : timeouts.idle_ms;
+    if (interval > 0) {
+        watchdog->start(interval);
+    } else {
+        watchdog->stop();
+    }
 }
 
 /**
- * @brief Обработка ошибки сброса пароля
+ * @brief Закрытие соединения по истечении тайм-аута
+ *
+ * Соединение с неотправленными ответами или приостановленным чтением
+ * не считается простаивающим: оно ждёт клиента, а не наоборот
  */
-void client::slot_reset_error() {
-    this->client_socket->write("reset|error");
+void client::slot_watchdog_timeout() {
+    const bool partial = protocol == protocol_mode::UNKNOWN ? !negotiation.isEmpty() : incoming.pending() > 0;
+    if (!partial && (reading_paused || queued_bytes() > 0)) {
+        restart_watchdog();
+        return;
+    }
+
+    if (partial) {
+        qDebug() << QString("%1 Клиент ").arg(servers_functions->get_server_time())
+                 << &client_socket
+                 << QString(" не закончил передачу сообщения за %1 мс, соединение закрыто").arg(timeouts.read_ms);
+        client_socket->abort();
+        slot_close_connection();
+    } else {
+        qDebug() << QString("%1 Клиент ").arg(servers_functions->get_server_time())
+                 << &client_socket
+                 << QString(" бездействовал %1 мс, соединение закрыто").arg(timeouts.idle_ms);
+        client_socket->disconnectFromHost();
+    }
 }
 
 /**
- * @brief Обработка успешного сброса пароля
+ * @brief Объём неотправленных ответов соединения
+ * @return Байты в очереди
  */
-void client::slot_reset_ok() {
-    this->client_socket->write("reset|ok");
+qint64 client::queued_bytes() const {
+    return queued.load(std::memory_order_relaxed);
 }
 
 /**
- * @brief Отправка решения уравнения клиенту
- * @param answer Решение для отправки
+ * @brief Обработка отключения клиента
  */
-void client::slot_equation_solution(QString answer) {
-    this->client_socket->write(answer.toUtf8());
+void client::slot_close_connection() {
+    this->client_socket->close();
+    this->deleteLater();
 }
-/// @}
 
 /// @name Служебные функции
 /// @{
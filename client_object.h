@@ -4,26 +4,54 @@
 #include <QObject>
 #include <QTcpSocket>
 #include <QThread>
+#include <QTimer>
+#include <atomic>
+#include "frame_buffer.h"
+#include "request_context.h"
+#include "connection_registry.h"
+#include "request_dispatcher.h"
 
 /**
  * @brief Класс клиента для обработки соединения и взаимодействия с сервером
+ *
+ * Соединение сетевой подсистемы на основе QTcpServer: сокет обслуживается
+ * циклом событий одного из потоков worker_pool
  */
-class client: public QObject
+class client: public QObject, public reply_sink
 {
     Q_OBJECT
 public:
+    static const qint64 socket_chunk = 256 * 1024;         ///< Наибольший объём, передаваемый сокету сверх ещё не отправленного
+    static const qint64 read_buffer_size = 1024 * 1024;    ///< Размер буфера чтения сокета
+
     /**
     * @brief Конструктор клиента
     * @param client_description Дескриптор клиента
+    * @param timeouts Тайм-ауты соединения
     * @param parent Родительский объект
     */
-    client(qintptr client_description, QObject* parent = nullptr);
+    client(qintptr client_description, const connection_timeouts& timeouts = connection_timeouts(),
+           QObject* parent = nullptr);
 
     /**
     * @brief Деструктор клиента
     */
     ~client();
 
+    /**
+    * @brief Передача ответа в поток соединения
+    * @param message Сообщение в формате "action|payload"
+    */
+    void deliver(const QByteArray& message) override;
+
+    /**
+    * @brief Объём неотправленных ответов соединения
+    * @return Байты в очереди соединения и в буфере записи сокета
+    *
+    * Может вызываться из любого потока
+    */
+    qint64 queued_bytes() const override;
+
 public slots:
 
 private slots:
@@ -42,53 +70,18 @@ private slots:
     */
     void slot_read_from_client();
 
-    /// @name Регистрация
-    /// @{
-    /**
-    * @brief Отправка клиенту сообщения об успешной регистрации
-    */
-    void slot_register_ok();
-
-    /**
-    * @brief Отправка клиенту сообщения об ошибке при регистрации
-    */
-    void slot_register_error();
-    /// @}
-
-    /// @name Авторизация
-    /// @{
-    /**
-    * @brief Отправка клиенту сообщения об успешной авторизации
-    */
-    void slot_auth_ok();
-
-    /**
-    * @brief Отправка клиенту сообщения об ошибке при авторизации
-    */
-    void slot_auth_error();
-    /// @}
-
-    /// @name Сброс пароля
-    /// @{
     /**
-    * @brief Отправка сообщения об ошибке при сбросе пароля (логин не найден в БД)
+    * @brief Передача очереди ответов сокету
+    *
+    * Вызывается один раз за проход цикла событий после добавления ответов
+    * и при каждой отправке части буфера записи сокета
     */
-    void slot_reset_error();
+    void slot_flush_outgoing();
 
     /**
-    * @brief Отправка сообщения об успешном сбросе пароля
+    * @brief Закрытие соединения по истечении тайм-аута
     */
-    void slot_reset_ok();
-    /// @}
-
-    /// @name Главное клиентское окно
-    /// @{
-    /**
-    * @brief Отправка клиенту решения уравнения
-    * @param answer Ответ с решением уравнения
-    */
-    void slot_equation_solution(QString answer);
-    /// @}
+    void slot_watchdog_timeout();
 
 signals:
     /**
@@ -96,74 +89,52 @@ signals:
     */
     void finished();
 
-    /// @name Сигналы для регистрации
-    /// @{
-    /**
-    * @brief Сигнал регистрации нового аккаунта
-    * @param login Логин
-    * @param password Пароль
-    * @param email Email
-    * @param last_name Фамилия
-    * @param first_name Имя
-    * @param middle_name Отчество
-    */
-    void signal_register_new_account(QString login, QString password, QString email, QString last_name, QString first_name, QString middle_name);
-    /// @}
-
-    /// @name Сигналы для авторизации
-    /// @{
-    /**
-    * @brief Сигнал авторизации
-    * @param login Логин
-    * @param password Пароль
-    */
-    void signal_auth(QString login, QString password);
-    /// @}
-
-    /// @name Сброс пароля
-    /// @{
-    /**
-    * @brief Сигнал отправки кода на email клиента
-    * @param email Email клиента
-    * @param code Код подтверждения
-    */
-    void signal_send_code_to_email(QString email, QString code);
+private:
+    QTcpSocket* client_socket;       ///< Сокет клиента
+    qintptr client_description;      ///< Дескриптор клиента
+    protocol_mode protocol = protocol_mode::UNKNOWN; ///< Согласованная версия протокола
+    QByteArray negotiation;          ///< Начало потока до завершения согласования
+    frame_buffer incoming;           ///< Буфер сборки кадров протокола v2
+    request_context context;         ///< Контекст запросов этого соединения
+    QByteArray outgoing;             ///< Очередь ответов, ещё не переданных сокету
+    int outgoing_offset = 0;         ///< Начало непереданной части outgoing
+    bool flush_scheduled = false;    ///< Передача очереди уже запланирована
+    bool reading_paused = false;     ///< Чтение остановлено до разгрузки очереди
+    std::atomic<qint64> queued{0};   ///< Объём неотправленных ответов
+    connection_timeouts timeouts;    ///< Тайм-ауты соединения
+    QTimer* watchdog;                ///< Таймер простоя и незавершённого чтения
+    request_dispatcher* dispatcher;  ///< Разбор сообщений и передача обработчикам
 
     /**
-    * @brief Сигнал установки нового пароля
-    * @param email Email клиента
-    * @param password Новый пароль
+    * @brief Отправка сообщения клиенту в согласованном формате
+    * @param message Сообщение в формате "action|payload"
     */
-    void signal_set_new_password(QString email, QString password);
-    /// @}
+    void send(const QByteArray& message);
 
-    /// @name Главное клиентское окно
-    /// @{
     /**
-    * @brief Сигнал решения линейного уравнения
-    * @param a Коэффициент a
-    * @param b Коэффициент b
+    * @brief Добавление байтов в очередь ответов
+    * @param bytes Данные для отправки
+    *
+    * Ответы, добавленные за один проход цикла событий, передаются
+    * сокету одной записью
     */
-    void signal_linear_equation(QString a, QString b);
+    void enqueue(const QByteArray& bytes);
 
     /**
-    * @brief Сигнал решения квадратного уравнения
-    * @param a Коэффициент a
-    * @param b Коэффициент b
-    * @param c Коэффициент c
+    * @brief Пересчёт объёма очереди и управление чтением
+    *
+    * Выше high_water_mark чтение из сокета прекращается, ниже
+    * low_water_mark возобновляется
     */
-    void signal_quadratic_equation(QString a, QString b, QString c);
-    /// @}
+    void update_queued();
 
     /**
-    * @brief Сигнал удаления потока
+    * @brief Перезапуск таймера соединения
+    *
+    * Если кадр или строка согласования приняты не полностью, таймер
+    * отсчитывает тайм-аут чтения, иначе тайм-аут простоя
     */
-    void del_thread();
-
-private:
-    QTcpSocket* client_socket;       ///< Сокет клиента
-    qintptr client_description;      ///< Дескриптор клиента
-    QThread* thread_for_client;      ///< Поток для клиента
+    void restart_watchdog();
 
     /**
     * @brief Отправка приветственного сообщения в консоль при новом подключении
@@ -0,0 +1,128 @@
+#include "../include/compute_pool.h"
+
+/// Статические члены класса
+thread_local compute_pool* compute_pool::current_pool = nullptr;
+thread_local int compute_pool::current_index = -1;
+
+/**
+ * @brief Конструктор пула
+ * @param size Количество потоков (0 - по числу ядер процессора)
+ */
+compute_pool::compute_pool(int size) {
+    if (size <= 0) {
+        size = qMax(1, QThread::idealThreadCount());
+    }
+
+    for (int i = 0; i < size; i++) {
+        queues.push_back(std::make_unique<worker_queue>());
+    }
+    for (int i = 0; i < size; i++) {
+        QThread* thread = QThread::create([this, i]() { run(i); });
+        thread->setObjectName(QString("compute_worker_%1").arg(i));
+        thread->start();
+        threads.push_back(thread);
+    }
+}
+
+/**
+ * @brief Деструктор пула
+ */
+compute_pool::~compute_pool() {
+    {
+        QMutexLocker locker(&sleep_mutex);
+        stopping = true;
+        wake.wakeAll();
+    }
+    for (QThread* thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+}
+
+/**
+ * @brief Возвращает количество потоков в пуле
+ * @return Размер пула
+ */
+int compute_pool::size() const {
+    return threads.size();
+}
+
+/**
+ * @brief Ставит задачу в очередь
+ * @param task Задача
+ */
+void compute_pool::submit(job task) {
+    int index;
+    if (current_pool == this) {
+        index = current_index;
+    } else {
+        index = int(next_queue.fetch_add(1, std::memory_order_relaxed) % unsigned(queues.size()));
+    }
+
+    // Счётчик увеличивается до публикации задачи: иначе поток, успевший её
+    // забрать, уменьшил бы его ниже нуля и спящие потоки не уснули бы
+    queued.fetch_add(1);
+    {
+        QMutexLocker locker(&queues[index]->mutex);
+        queues[index]->jobs.push_back(std::move(task));
+    }
+
+    QMutexLocker locker(&sleep_mutex);
+    wake.wakeOne();
+}
+
+/**
+ * @brief Забирает задачу для потока
+ * @param index Номер потока
+ * @param task Полученная задача
+ * @return true если задача получена
+ *
+ * Сначала проверяется конец собственной очереди, затем начало очередей
+ * остальных потоков
+ */
+bool compute_pool::take(int index, job& task) {
+    {
+        worker_queue& own = *queues[index];
+        QMutexLocker locker(&own.mutex);
+        if (!own.jobs.empty()) {
+            task = std::move(own.jobs.back());
+            own.jobs.pop_back();
+            return true;
+        }
+    }
+
+    const int count = int(queues.size());
+    for (int shift = 1; shift < count; shift++) {
+        worker_queue& victim = *queues[(index + shift) % count];
+        QMutexLocker locker(&victim.mutex);
+        if (!victim.jobs.empty()) {
+            task = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Цикл работы потока пула
+ * @param index Номер потока
+ */
+void compute_pool::run(int index) {
+    current_pool = this;
+    current_index = index;
+
+    while (!stopping) {
+        job task;
+        if (take(index, task)) {
+            queued.fetch_sub(1);
+            task();
+            continue;
+        }
+
+        QMutexLocker locker(&sleep_mutex);
+        while (queued.load() == 0 && !stopping) {
+            wake.wait(&sleep_mutex);
+        }
+    }
+}
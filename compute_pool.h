@@ -0,0 +1,94 @@
+#ifndef COMPUTE_POOL_H
+#define COMPUTE_POOL_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QVector>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+
+/**
+ * @brief Пул вычислительных потоков с перехватом задач (work stealing)
+ *
+ * Используется для решения уравнений и не связан с потоками ввода-вывода,
+ * поэтому тяжёлые вычисления не задерживают приём и обслуживание соединений.
+ *
+ * У каждого потока своя очередь задач. Поток берёт задачи с конца своей
+ * очереди, а когда она пуста - забирает задачи из начала очередей других
+ * потоков. Задача, поставленная из потока пула, попадает в его собственную
+ * очередь, остальные распределяются по очередям по кругу.
+ */
+class compute_pool
+{
+public:
+    using job = std::function<void()>; ///< Задача пула
+
+    /**
+     * @brief Конструктор пула
+     * @param size Количество потоков (0 - по числу ядер процессора)
+     */
+    explicit compute_pool(int size = 0);
+
+    /**
+     * @brief Деструктор
+     *
+     * Дожидается завершения потоков; невыполненные задачи отбрасываются
+     */
+    ~compute_pool();
+
+    /**
+     * @brief Постановка задачи в пул
+     * @param task Задача
+     *
+     * Может вызываться из любого потока
+     */
+    void submit(job task);
+
+    /**
+     * @brief Количество потоков в пуле
+     * @return Размер пула
+     */
+    int size() const;
+
+private:
+    /**
+     * @brief Очередь задач одного потока
+     */
+    struct worker_queue {
+        QMutex mutex;         ///< Защита очереди
+        std::deque<job> jobs; ///< Задачи потока
+    };
+
+    QVector<QThread*> threads;                         ///< Потоки пула
+    std::vector<std::unique_ptr<worker_queue>> queues; ///< Очереди потоков
+    QMutex sleep_mutex;                                ///< Мьютекс ожидания задач
+    QWaitCondition wake;                               ///< Пробуждение свободных потоков
+    std::atomic<int> queued{0};                        ///< Количество невыполненных задач
+    std::atomic<unsigned> next_queue{0};               ///< Очередь для следующей внешней задачи
+    std::atomic<bool> stopping{false};                 ///< Признак остановки пула
+
+    static thread_local compute_pool* current_pool; ///< Пул, которому принадлежит текущий поток
+    static thread_local int current_index;          ///< Номер текущего потока в пуле
+
+    /**
+     * @brief Цикл работы потока пула
+     * @param index Номер потока
+     */
+    void run(int index);
+
+    /**
+     * @brief Получение задачи из своей очереди или из чужой
+     * @param index Номер потока
+     * @param task Полученная задача
+     * @return true если задача получена
+     */
+    bool take(int index, job& task);
+
+    compute_pool(const compute_pool&) = delete;            ///< Запрет копирования
+    compute_pool& operator=(const compute_pool&) = delete; ///< Запрет присваивания
+};
+
+#endif // COMPUTE_POOL_H
@@ -0,0 +1,55 @@
+#include "../include/connection_registry.h"
+
+/// Статические члены класса
+QHash<quint64, reply_sink*> connection_registry::sinks;
+QMutex connection_registry::mutex;
+quint64 connection_registry::next_connection_id = 1;
+
+/**
+ * @brief Регистрирует соединение
+ * @param sink Получатель ответов
+ * @return Идентификатор соединения
+ */
+quint64 connection_registry::add(reply_sink* sink) {
+    QMutexLocker locker(&mutex);
+    const quint64 connection_id = next_connection_id++;
+    sinks.insert(connection_id, sink);
+    return connection_id;
+}
+
+/**
+ * @brief Удаляет соединение
+ * @param connection_id Идентификатор соединения
+ */
+void connection_registry::remove(quint64 connection_id) {
+    QMutexLocker locker(&mutex);
+    sinks.remove(connection_id);
+}
+
+/**
+ * @brief Доставляет ответ в соединение-отправитель
+ * @param context Контекст запроса
+ * @param message Сообщение для отправки
+ *
+ * Пока удерживается мьютекс, соединение не может быть удалено
+ */
+void connection_registry::reply(const request_context& context, const QByteArray& message) {
+    QMutexLocker locker(&mutex);
+    reply_sink* target = sinks.value(context.connection_id, nullptr);
+    if (target != nullptr) {
+        target->deliver(message);
+    }
+}
+
+/**
+ * @brief Возвращает объём неотправленных ответов всех соединений
+ * @return Байты в очереди по идентификатору соединения
+ */
+QHash<quint64, qint64> connection_registry::queue_statistics() {
+    QMutexLocker locker(&mutex);
+    QHash<quint64, qint64> result;
+    for (auto it = sinks.constBegin(); it != sinks.constEnd(); ++it) {
+        result.insert(it.key(), it.value()->queued_bytes());
+    }
+    return result;
+}
@@ -0,0 +1,94 @@
+#ifndef CONNECTION_REGISTRY_H
+#define CONNECTION_REGISTRY_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include "request_context.h"
+
+/**
+ * @brief Тайм-ауты соединения
+ *
+ * Нулевое или отрицательное значение отключает соответствующую проверку
+ */
+struct connection_timeouts
+{
+    int idle_ms = 300000; ///< Наибольшее время без сообщений от клиента
+    int read_ms = 30000;  ///< Наибольшее время приёма начатого кадра или строки согласования
+};
+
+/**
+ * @brief Получатель ответов одного соединения
+ *
+ * Реализуется каждой сетевой подсистемой (client для QTcpServer,
+ * соединение epoll_server), поэтому обработчики запросов отвечают
+ * через connection_registry, не зная, какая подсистема приняла запрос
+ */
+class reply_sink
+{
+public:
+    static const qint64 high_water_mark = 4 * 1024 * 1024; ///< Объём очереди ответов, при котором чтение приостанавливается
+    static const qint64 low_water_mark = 1024 * 1024;      ///< Объём очереди ответов, при котором чтение возобновляется
+
+    virtual ~reply_sink() = default;
+
+    /**
+     * @brief Передача ответа соединению
+     * @param message Сообщение в формате "action|payload"
+     *
+     * Вызывается из любого потока под защитой реестра и не должна
+     * блокироваться: ответ только передаётся потоку соединения
+     */
+    virtual void deliver(const QByteArray& message) = 0;
+
+    /**
+     * @brief Объём неотправленных ответов
+     * @return Байты в очереди соединения
+     */
+    virtual qint64 queued_bytes() const = 0;
+};
+
+/**
+ * @brief Реестр открытых соединений всех сетевых подсистем
+ */
+class connection_registry
+{
+public:
+    /**
+     * @brief Регистрация соединения
+     * @param sink Получатель ответов соединения
+     * @return Идентификатор соединения для request_context
+     */
+    static quint64 add(reply_sink* sink);
+
+    /**
+     * @brief Удаление соединения
+     * @param connection_id Идентификатор соединения
+     *
+     * После возврата deliver для этого соединения больше не вызывается
+     */
+    static void remove(quint64 connection_id);
+
+    /**
+     * @brief Доставка ответа в соединение, из которого пришёл запрос
+     * @param context Контекст запроса
+     * @param message Сообщение в формате "action|payload"
+     *
+     * Может вызываться из любого потока. Если соединение уже закрыто,
+     * ответ отбрасывается
+     */
+    static void reply(const request_context& context, const QByteArray& message);
+
+    /**
+     * @brief Объём неотправленных ответов всех соединений
+     * @return Байты в очереди по идентификатору соединения
+     */
+    static QHash<quint64, qint64> queue_statistics();
+
+private:
+    static QHash<quint64, reply_sink*> sinks; ///< Открытые соединения по идентификатору
+    static QMutex mutex;                      ///< Защита sinks
+    static quint64 next_connection_id;        ///< Идентификатор следующего соединения
+};
+
+#endif // CONNECTION_REGISTRY_H
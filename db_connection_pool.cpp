@@ -0,0 +1,266 @@
+#include "../include/db_connection_pool.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QStringList>
+#include <QtSql/QSqlError>
+#include <QtAlgorithms>
+
+/// Номер следующего соединения; имена QSqlDatabase общие для всех пулов процесса
+static std::atomic<int> next_connection_id{0};
+
+/**
+ * @brief Конструктор пула
+ * @param database_name Путь к файлу базы данных
+ * @param size Наибольшее число одновременных аренд
+ * @param profile Настройки соединений
+ */
+db_connection_pool::db_connection_pool(const QString& database_name, int size, const sqlite_profile& profile)
+    : database_name(database_name), profile(profile),
+      capacity(size > 0 ? size : qMax(1, QThread::idealThreadCount())), permits(capacity) {
+}
+
+/**
+ * @brief Деструктор пула
+ *
+ * Вызывается из DBSingleton::shutdown после остановки потоков ввода-вывода
+ * и потока записи, поэтому соединения, оставшиеся в пуле, больше никем не
+ * используются
+ */
+db_connection_pool::~db_connection_pool() {
+    const QList<QThread*> threads = connections.keys();
+    for (QThread* thread : threads) {
+        QObject::disconnect(connections.value(thread)->cleanup);
+        close_connection(thread);
+    }
+}
+
+/**
+ * @brief Возвращает размер пула
+ * @return Наибольшее число одновременных аренд
+ */
+int db_connection_pool::size() const {
+    return capacity;
+}
+
+/**
+ * @brief Возвращает счётчики пула
+ * @return Снимок счётчиков
+ */
+db_connection_pool::counters db_connection_pool::statistics() const {
+    counters result;
+    result.leases = leases.load(std::memory_order_relaxed);
+    result.waits = waits.load(std::memory_order_relaxed);
+    result.total_wait_us = total_wait_us.load(std::memory_order_relaxed);
+    result.max_wait_us = max_wait_us.load(std::memory_order_relaxed);
+    result.prepares = prepares.load(std::memory_order_relaxed);
+    result.reuses = reuses.load(std::memory_order_relaxed);
+    QMutexLocker locker(&mutex);
+    result.connections = connections.size();
+    return result;
+}
+
+/**
+ * @brief Выдаёт соединение текущему потоку
+ * @param nested Признак вложенной аренды
+ * @return Описание соединения потока
+ */
+db_connection_pool::thread_connection* db_connection_pool::acquire(bool& nested) {
+    QThread* thread = QThread::currentThread();
+    {
+        QMutexLocker locker(&mutex);
+        thread_connection* found = connections.value(thread, nullptr);
+        if (found != nullptr && found->depth > 0) {
+            found->depth++;
+            nested = true;
+            return found;
+        }
+    }
+
+    // Ожидание свободного места учитывается в статистике
+    if (!permits.tryAcquire()) {
+        QElapsedTimer timer;
+        timer.start();
+        permits.acquire();
+        const qint64 waited = timer.nsecsElapsed() / 1000;
+        waits.fetch_add(1, std::memory_order_relaxed);
+        total_wait_us.fetch_add(waited, std::memory_order_relaxed);
+        qint64 longest = max_wait_us.load(std::memory_order_relaxed);
+        while (waited > longest && !max_wait_us.compare_exchange_weak(longest, waited)) {
+        }
+    }
+    leases.fetch_add(1, std::memory_order_relaxed);
+
+    QMutexLocker locker(&mutex);
+    thread_connection* found = connections.value(thread, nullptr);
+    if (found == nullptr) {
+        found = open_connection(thread);
+        connections.insert(thread, found);
+    }
+    found->depth = 1;
+    nested = false;
+    return found;
+}
+
+/**
+ * @brief Возвращает соединение в пул
+ * @param owner Описание соединения потока
+ * @param nested Признак вложенной аренды
+ *
+ * Соединение остаётся открытым для следующих аренд этого потока
+ */
+void db_connection_pool::release(thread_connection* owner, bool nested) {
+    owner->depth--;
+    if (!nested) {
+        permits.release();
+    }
+}
+
+/**
+ * @brief Ищет или готовит запрос соединения текущего потока
+ * @param owner Описание соединения потока
+ * @param database Соединение
+ * @param id Идентификатор запроса
+ * @param sql Текст запроса
+ * @return Запрос или nullptr
+ *
+ * Кэш соединения меняет только его собственный поток, поэтому поиск
+ * выполняется без мьютекса пула
+ */
+QSqlQuery* db_connection_pool::statement(thread_connection* owner, const QSqlDatabase& database, int id,
+                                         const char* sql) {
+    QSqlQuery* cached = owner->statements.value(id, nullptr);
+    if (cached != nullptr) {
+        reuses.fetch_add(1, std::memory_order_relaxed);
+        return cached;
+    }
+
+    QSqlQuery* prepared = new QSqlQuery(database);
+    prepared->setForwardOnly(true);
+    if (!prepared->prepare(sql)) {
+        qDebug() << "Ошибка подготовки запроса" << id << ":" << prepared->lastError().text();
+        delete prepared;
+        return nullptr;
+    }
+    prepares.fetch_add(1, std::memory_order_relaxed);
+    owner->statements.insert(id, prepared);
+    return prepared;
+}
+
+/**
+ * @brief Открывает соединение для текущего потока
+ * @param thread Текущий поток
+ * @return Описание соединения
+ *
+ * Соединение закрывается в самом потоке по сигналу finished
+ */
+db_connection_pool::thread_connection* db_connection_pool::open_connection(QThread* thread) {
+    thread_connection* result = new thread_connection;
+    result->name = QString("db_pool_%1").arg(next_connection_id++);
+
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", result->name);
+    db.setDatabaseName(database_name);
+    if (!db.open()) {
+        qDebug() << "Ошибка: Не удалось открыть соединение" << result->name << ":" << db.lastError().text();
+    } else {
+        apply_profile(db);
+    }
+
+    result->cleanup = QObject::connect(thread, &QThread::finished, [this, thread]() {
+        close_connection(thread);
+    });
+    return result;
+}
+
+/**
+ * @brief Применяет настройки к соединению
+ * @param database Открытое соединение
+ *
+ * В режиме WAL читатели не блокируют писателя, а с synchronous=NORMAL
+ * фиксация транзакции не ждёт fsync: журнал синхронизируется при checkpoint.
+ * Поток db_writer переводит своё соединение в synchronous=FULL
+ */
+void db_connection_pool::apply_profile(const QSqlDatabase& database) const {
+    const QStringList pragmas = {
+        QString("PRAGMA busy_timeout = %1").arg(profile.busy_timeout_ms),
+        QString("PRAGMA journal_mode = %1").arg(profile.wal ? "WAL" : "DELETE"),
+        QString("PRAGMA synchronous = %1").arg(profile.synchronous),
+        QString("PRAGMA cache_size = -%1").arg(profile.cache_size_kib),
+        QString("PRAGMA mmap_size = %1").arg(profile.mmap_size),
+        QString("PRAGMA temp_store = %1").arg(profile.temp_store_memory ? "MEMORY" : "DEFAULT"),
+    };
+    QSqlQuery query(database);
+    for (const QString& pragma : pragmas) {
+        if (!query.exec(pragma)) {
+            qDebug() << "Ошибка настройки соединения:" << pragma << query.lastError().text();
+        }
+        query.finish();
+    }
+}
+
+/**
+ * @brief Закрывает соединение потока
+ * @param thread Поток
+ */
+void db_connection_pool::close_connection(QThread* thread) {
+    QString name;
+    {
+        QMutexLocker locker(&mutex);
+        thread_connection* found = connections.take(thread);
+        if (found == nullptr) {
+            return;
+        }
+        name = found->name;
+        // Подготовленные запросы удаляются до закрытия соединения
+        qDeleteAll(found->statements);
+        delete found;
+    }
+    {
+        QSqlDatabase db = QSqlDatabase::database(name, false);
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(name);
+}
+
+/**
+ * @brief Конструктор аренды
+ * @param pool Пул соединений
+ */
+db_connection_pool::lease::lease(db_connection_pool& pool) : pool(pool) {
+    owner = pool.acquire(nested);
+    connection = QSqlDatabase::database(owner->name, false);
+}
+
+/**
+ * @brief Деструктор аренды
+ */
+db_connection_pool::lease::~lease() {
+    // Незавершённое чтение удерживало бы блокировку базы до следующего вызова
+    for (QSqlQuery* query : used) {
+        query->finish();
+    }
+    connection = QSqlDatabase();
+    pool.release(owner, nested);
+}
+
+/**
+ * @brief Возвращает соединение текущего потока
+ * @return Соединение
+ */
+QSqlDatabase db_connection_pool::lease::database() const {
+    return connection;
+}
+
+/**
+ * @brief Возвращает подготовленный запрос соединения
+ * @param id Идентификатор запроса
+ * @param sql Текст запроса
+ * @return Запрос или nullptr
+ */
+QSqlQuery* db_connection_pool::lease::statement(int id, const char* sql) {
+    QSqlQuery* query = pool.statement(owner, connection, id, sql);
+    if (query != nullptr && !used.contains(query)) {
+        used.push_back(query);
+    }
+    return query;
+}
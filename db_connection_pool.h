@@ -0,0 +1,215 @@
+#ifndef DB_CONNECTION_POOL_H
+#define DB_CONNECTION_POOL_H
+
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+#include <QHash>
+#include <QMutex>
+#include <QSemaphore>
+#include <QString>
+#include <QThread>
+#include <QVector>
+#include <atomic>
+
+/**
+ * @brief Настройки производительности соединений SQLite
+ *
+ * Применяются к каждому соединению пула при открытии (PRAGMA)
+ */
+struct sqlite_profile {
+    bool wal = true;                      ///< journal_mode=WAL вместо журнала отката
+    QString synchronous = "NORMAL";       ///< Режим synchronous (OFF, NORMAL, FULL)
+    int cache_size_kib = 16 * 1024;       ///< Кэш страниц соединения в КиБ (cache_size)
+    qint64 mmap_size = 256 * 1024 * 1024; ///< Объём файла, читаемый через mmap (mmap_size)
+    bool temp_store_memory = true;        ///< Временные таблицы в памяти (temp_store)
+    int busy_timeout_ms = 5000;           ///< Ожидание блокировки другим соединением (busy_timeout)
+};
+
+/**
+ * @brief Пул соединений SQLite с отдельным соединением на каждый поток
+ *
+ * QSqlDatabase можно использовать только в потоке, который его открыл,
+ * поэтому каждый поток получает собственное именованное соединение с тем же
+ * файлом базы. Соединение открывается при первой аренде в потоке и
+ * закрывается при завершении потока. Число одновременных аренд ограничено
+ * размером пула; поток, которому не хватило места, ждёт, а время ожидания
+ * учитывается в статистике.
+ *
+ * У каждого соединения есть кэш подготовленных запросов по идентификатору:
+ * SQLite разбирает и планирует запрос один раз, а при следующих вызовах
+ * заново связываются только параметры
+ */
+class db_connection_pool
+{
+public:
+    /**
+     * @brief Счётчики работы пула
+     */
+    struct counters {
+        quint64 leases = 0;       ///< Выданные аренды (без вложенных)
+        quint64 waits = 0;        ///< Аренды, которым пришлось ждать свободного места
+        qint64 total_wait_us = 0; ///< Суммарное время ожидания в микросекундах
+        qint64 max_wait_us = 0;   ///< Наибольшее время ожидания в микросекундах
+        int connections = 0;      ///< Открытые соединения
+        quint64 prepares = 0;     ///< Подготовленные запросы
+        quint64 reuses = 0;       ///< Повторные использования подготовленных запросов
+    };
+
+private:
+    struct thread_connection; ///< Соединение потока (объявлено ниже)
+
+public:
+    /**
+     * @brief Аренда соединения текущего потока
+     *
+     * Соединение доступно, пока существует объект аренды, и используется
+     * только в создавшем его потоке. Аренда внутри аренды того же потока
+     * возвращает то же соединение и не занимает места в пуле
+     */
+    class lease
+    {
+    public:
+        /**
+         * @brief Получение соединения
+         * @param pool Пул соединений
+         *
+         * Ждёт, пока в пуле не освободится место
+         */
+        explicit lease(db_connection_pool& pool);
+
+        /**
+         * @brief Возврат соединения в пул
+         */
+        ~lease();
+
+        /**
+         * @brief Соединение текущего потока
+         * @return Открытое соединение или недействительный объект при ошибке
+         */
+        QSqlDatabase database() const;
+
+        /**
+         * @brief Подготовленный запрос соединения
+         * @param id Идентификатор запроса
+         * @param sql Текст запроса (используется только при первой подготовке)
+         * @return Запрос или nullptr, если его не удалось подготовить
+         *
+         * Запрос принадлежит соединению и остаётся в кэше; по окончании
+         * аренды его результат освобождается (finish)
+         */
+        QSqlQuery* statement(int id, const char* sql);
+
+    private:
+        db_connection_pool& pool;   ///< Пул соединений
+        thread_connection* owner;   ///< Описание соединения текущего потока
+        QSqlDatabase connection;    ///< Соединение текущего потока
+        bool nested = false;        ///< Вложенная аренда
+        QVector<QSqlQuery*> used;   ///< Запросы, использованные в аренде
+
+        lease(const lease&) = delete;            ///< Запрет копирования
+        lease& operator=(const lease&) = delete; ///< Запрет присваивания
+    };
+
+    /**
+     * @brief Конструктор пула
+     * @param database_name Путь к файлу базы данных
+     * @param size Наибольшее число одновременных аренд (0 - по числу ядер)
+     * @param profile Настройки соединений
+     */
+    db_connection_pool(const QString& database_name, int size, const sqlite_profile& profile = sqlite_profile());
+
+    /**
+     * @brief Деструктор
+     *
+     * Закрывает соединения потоков, которые ещё не завершились
+     */
+    ~db_connection_pool();
+
+    /**
+     * @brief Размер пула
+     * @return Наибольшее число одновременных аренд
+     */
+    int size() const;
+
+    /**
+     * @brief Счётчики работы пула
+     * @return Снимок счётчиков
+     */
+    counters statistics() const;
+
+private:
+    /**
+     * @brief Соединение потока
+     *
+     * Глубину аренд и кэш запросов меняет только поток-владелец, поэтому
+     * аренда обращается к ним без мьютекса. Описание хранится отдельно от
+     * таблицы connections, чтобы указатель на него не менялся при вставке
+     * соединений других потоков
+     */
+    struct thread_connection {
+        QString name;                      ///< Имя соединения в QSqlDatabase
+        int depth = 0;                     ///< Глубина вложенных аренд
+        QMetaObject::Connection cleanup;   ///< Закрытие при завершении потока
+        QHash<int, QSqlQuery*> statements; ///< Подготовленные запросы по идентификатору
+    };
+
+    QString database_name;                          ///< Путь к файлу базы данных
+    sqlite_profile profile;                         ///< Настройки соединений
+    int capacity;                                   ///< Размер пула
+    QSemaphore permits;                             ///< Свободные места
+    mutable QMutex mutex;                           ///< Защита connections
+    QHash<QThread*, thread_connection*> connections; ///< Соединения по потокам
+    std::atomic<quint64> leases{0};                 ///< Выданные аренды
+    std::atomic<quint64> waits{0};                  ///< Аренды с ожиданием
+    std::atomic<qint64> total_wait_us{0};           ///< Суммарное ожидание
+    std::atomic<qint64> max_wait_us{0};             ///< Наибольшее ожидание
+    std::atomic<quint64> prepares{0};               ///< Подготовленные запросы
+    std::atomic<quint64> reuses{0};                 ///< Повторные использования запросов
+
+    /**
+     * @brief Выдача соединения текущему потоку
+     * @param nested Признак вложенной аренды
+     * @return Описание соединения потока
+     */
+    thread_connection* acquire(bool& nested);
+
+    /**
+     * @brief Возврат соединения
+     * @param owner Описание соединения потока
+     * @param nested Признак вложенной аренды
+     */
+    void release(thread_connection* owner, bool nested);
+
+    /**
+     * @brief Поиск или подготовка запроса соединения текущего потока
+     * @param owner Описание соединения потока
+     * @param database Соединение
+     * @param id Идентификатор запроса
+     * @param sql Текст запроса
+     * @return Запрос или nullptr
+     */
+    QSqlQuery* statement(thread_connection* owner, const QSqlDatabase& database, int id, const char* sql);
+
+    /**
+     * @brief Открытие соединения для текущего потока
+     * @param thread Текущий поток
+     * @return Описание соединения
+     */
+    thread_connection* open_connection(QThread* thread);
+
+    /**
+     * @brief Применение настроек к открытому соединению
+     * @param database Соединение
+     */
+    void apply_profile(const QSqlDatabase& database) const;
+
+    /**
+     * @brief Закрытие соединения потока
+     * @param thread Завершающийся поток
+     */
+    void close_connection(QThread* thread);
+
+    db_connection_pool(const db_connection_pool&) = delete; ///< Запрет копирования
+};
+
+#endif // DB_CONNECTION_POOL_H
@@ -0,0 +1,99 @@
+#ifndef DB_CURSOR_H
+#define DB_CURSOR_H
+
+#include <QtSql/QSqlQuery>
+#include <QVariant>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Типизированный потоковый курсор по результату запроса
+ *
+ * Читает из каждой строки только объявленные столбцы (по порядку, начиная
+ * с нулевого) сразу в значения нужных типов. Строки не накапливаются:
+ * следующая строка запрашивается у SQLite только при вызове next, поэтому
+ * запрос должен быть выполнен в режиме forward-only
+ *
+ * @tparam Columns Типы столбцов результата
+ */
+template<typename... Columns>
+class db_cursor
+{
+public:
+    using row = std::tuple<Columns...>; ///< Строка результата
+
+    /**
+     * @brief Конструктор курсора
+     * @param query Выполненный запрос
+     */
+    explicit db_cursor(QSqlQuery& query) : query(query) {
+    }
+
+    /**
+     * @brief Чтение следующей строки в переменные
+     * @param values Переменные для столбцов
+     * @return false если строки закончились
+     */
+    bool next(Columns&... values) {
+        if (!query.next()) {
+            return false;
+        }
+        int column = 0;
+        ((values = query.value(column++).template value<Columns>()), ...);
+        return true;
+    }
+
+    /**
+     * @brief Чтение следующей строки в кортеж
+     * @param values Строка результата
+     * @return false если строки закончились
+     */
+    bool next(row& values) {
+        return std::apply([this](Columns&... fields) { return next(fields...); }, values);
+    }
+
+    /**
+     * @brief Чтение следующей строки в структуру
+     * @tparam Struct Структура, поля которой идут в порядке столбцов
+     * @param value Результат
+     * @return false если строки закончились
+     */
+    template<typename Struct>
+    bool next_into(Struct& value) {
+        row values;
+        if (!next(values)) {
+            return false;
+        }
+        value = std::apply([](Columns&... fields) { return Struct{std::move(fields)...}; }, values);
+        return true;
+    }
+
+    /**
+     * @brief Передача всех оставшихся строк обработчику
+     * @param callback Обработчик, принимающий значения столбцов; если он
+     *        возвращает bool, false прекращает чтение
+     * @return Количество прочитанных строк
+     */
+    template<typename Callback>
+    int for_each(Callback&& callback) {
+        int count = 0;
+        row values;
+        while (next(values)) {
+            count++;
+            if constexpr (std::is_same_v<decltype(std::apply(callback, values)), bool>) {
+                if (!std::apply(callback, values)) {
+                    break;
+                }
+            } else {
+                std::apply(callback, values);
+            }
+        }
+        return count;
+    }
+
+private:
+    QSqlQuery& query; ///< Выполненный запрос
+};
+
+#endif // DB_CURSOR_H
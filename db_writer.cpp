@@ -0,0 +1,189 @@
+#include "../include/db_writer.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QtSql/QSqlError>
+
+/// Идентификаторы служебных запросов в кэше соединения потока записи
+/// (отрицательные, чтобы не пересекаться с запросами DBSingleton)
+static const int savepoint_statement = -1;
+static const int release_statement = -2;
+static const int rollback_statement = -3;
+
+/**
+ * @brief Конструктор
+ * @param pool Пул соединений
+ * @param max_batch Наибольшее число изменений в транзакции
+ * @param max_delay_ms Наибольшая задержка пачки
+ */
+db_writer::db_writer(db_connection_pool& pool, int max_batch, int max_delay_ms)
+    : pool(pool), max_batch(qMax(1, max_batch)), max_delay_ms(qMax(0, max_delay_ms)) {
+    thread = QThread::create([this]() { run(); });
+    thread->setObjectName("db_writer");
+    thread->start();
+}
+
+/**
+ * @brief Деструктор
+ */
+db_writer::~db_writer() {
+    stop();
+    delete thread;
+}
+
+/**
+ * @brief Останавливает поток записи
+ */
+void db_writer::stop() {
+    {
+        QMutexLocker locker(&mutex);
+        stopping = true;
+    }
+    wake.wakeAll();
+    thread->wait();
+}
+
+/**
+ * @brief Ставит изменение в очередь
+ * @param change Изменение
+ * @param done Обработчик результата
+ */
+void db_writer::submit(mutation change, completion done) {
+    {
+        QMutexLocker locker(&mutex);
+        if (!stopping) {
+            queue.push_back({std::move(change), std::move(done)});
+            wake.wakeOne();
+            return;
+        }
+    }
+    done(false);
+}
+
+/**
+ * @brief Возвращает счётчики работы
+ * @return Снимок счётчиков
+ */
+db_writer::counters db_writer::statistics() const {
+    counters result;
+    result.writes = writes.load(std::memory_order_relaxed);
+    result.failures = failures.load(std::memory_order_relaxed);
+    result.batches = batches.load(std::memory_order_relaxed);
+    result.largest = largest.load(std::memory_order_relaxed);
+    return result;
+}
+
+/**
+ * @brief Цикл потока записи
+ *
+ * После первого изменения поток ждёт остальные не дольше max_delay_ms,
+ * пока пачка не заполнится. При остановке очередь дописывается до конца
+ */
+void db_writer::run() {
+    {
+        // Клиент получает ответ после фиксации пачки, поэтому фиксация должна
+        // дожидаться fsync журнала; соединение потока остаётся открытым до его
+        // завершения, и настройка действует для всех пачек
+        db_connection_pool::lease connection(pool);
+        QSqlQuery query(connection.database());
+        if (!query.exec("PRAGMA synchronous = FULL")) {
+            qDebug() << "Ошибка настройки соединения потока записи:" << query.lastError().text();
+        }
+    }
+
+    QMutexLocker locker(&mutex);
+    while (true) {
+        while (queue.empty() && !stopping) {
+            wake.wait(&mutex);
+        }
+        if (queue.empty()) {
+            break;
+        }
+
+        QElapsedTimer window;
+        window.start();
+        while (!stopping && int(queue.size()) < max_batch) {
+            const qint64 remaining = max_delay_ms - window.elapsed();
+            if (remaining <= 0) {
+                break;
+            }
+            wake.wait(&mutex, remaining);
+        }
+
+        QVector<pending> batch;
+        while (!queue.empty() && batch.size() < max_batch) {
+            batch.push_back(std::move(queue.front()));
+            queue.pop_front();
+        }
+
+        locker.unlock();
+        commit(batch);
+        locker.relock();
+    }
+}
+
+/**
+ * @brief Выполняет пачку изменений одной транзакцией
+ * @param batch Изменения
+ *
+ * Обработчики результата вызываются после фиксации; если транзакцию
+ * зафиксировать не удалось, все изменения пачки считаются неудачными.
+ * Если не удалось создать точку сохранения, изменение не выполняется.
+ * Если не удалось отменить или освободить точку сохранения, изменения
+ * нельзя отделить друг от друга, и вся пачка откатывается
+ */
+void db_writer::commit(QVector<pending>& batch) {
+    QVector<bool> results(batch.size(), false);
+    {
+        db_connection_pool::lease connection(pool);
+        QSqlDatabase db = connection.database();
+        QSqlQuery* savepoint = connection.statement(savepoint_statement, "SAVEPOINT mutation");
+        QSqlQuery* release = connection.statement(release_statement, "RELEASE mutation");
+        QSqlQuery* rollback = connection.statement(rollback_statement, "ROLLBACK TO mutation");
+
+        if (savepoint == nullptr || release == nullptr || rollback == nullptr) {
+            qDebug() << "Ошибка подготовки точек сохранения, пачка из" << batch.size() << "изменений отклонена";
+        } else if (!db.transaction()) {
+            qDebug() << "Ошибка начала транзакции пачки из" << batch.size() << "изменений:" << db.lastError().text();
+        } else {
+            bool broken = false;
+            for (int i = 0; i < batch.size() && !broken; i++) {
+                if (!savepoint->exec()) {
+                    qDebug() << "Ошибка создания точки сохранения:" << savepoint->lastError().text();
+                    continue;
+                }
+                results[i] = batch[i].change(connection);
+                // Отменяется только это изменение
+                if (!results[i] && !rollback->exec()) {
+                    qDebug() << "Ошибка отмены изменения:" << rollback->lastError().text();
+                    broken = true;
+                }
+                if (!release->exec()) {
+                    qDebug() << "Ошибка освобождения точки сохранения:" << release->lastError().text();
+                    broken = true;
+                }
+            }
+            if (broken) {
+                db.rollback();
+                results.fill(false);
+            } else if (!db.commit()) {
+                qDebug() << "Ошибка фиксации пачки изменений:" << db.lastError().text();
+                db.rollback();
+                results.fill(false);
+            }
+        }
+    }
+
+    const int size = batch.size();
+    batches.fetch_add(1, std::memory_order_relaxed);
+    int current = largest.load(std::memory_order_relaxed);
+    while (size > current && !largest.compare_exchange_weak(current, size)) {
+    }
+    for (int i = 0; i < size; i++) {
+        writes.fetch_add(1, std::memory_order_relaxed);
+        if (!results[i]) {
+            failures.fetch_add(1, std::memory_order_relaxed);
+        }
+        batch[i].done(results[i]);
+    }
+}
@@ -0,0 +1,120 @@
+#ifndef DB_WRITER_H
+#define DB_WRITER_H
+
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include "db_connection_pool.h"
+
+/**
+ * @brief Поток записи в базу с групповой фиксацией транзакций
+ *
+ * Изменения от всех потоков ввода-вывода собираются в очередь и
+ * выполняются одним потоком пачками: несколько изменений фиксируются
+ * одной транзакцией и одной синхронизацией журнала. Пачка закрывается,
+ * когда в ней набирается max_batch изменений или проходит max_delay_ms
+ * с момента поступления первого из них.
+ *
+ * Каждое изменение выполняется внутри своей точки сохранения (SAVEPOINT),
+ * поэтому ошибка одного изменения не отменяет остальные. Результат
+ * сообщается обработчику завершения после фиксации пачки. Соединение
+ * потока записи работает с synchronous=FULL: фиксация дожидается fsync
+ * журнала, и успешный результат означает, что изменение сохранено на диске
+ */
+class db_writer
+{
+public:
+    using mutation = std::function<bool(db_connection_pool::lease&)>; ///< Изменение: true при успехе
+    using completion = std::function<void(bool)>;                     ///< Обработчик результата изменения
+
+    /**
+     * @brief Счётчики работы потока записи
+     */
+    struct counters {
+        quint64 writes = 0;   ///< Выполненные изменения
+        quint64 failures = 0; ///< Неудачные изменения
+        quint64 batches = 0;  ///< Зафиксированные пачки
+        int largest = 0;      ///< Наибольший размер пачки
+    };
+
+    /**
+     * @brief Конструктор
+     * @param pool Пул соединений, из которого поток записи арендует своё соединение
+     * @param max_batch Наибольшее число изменений в одной транзакции
+     * @param max_delay_ms Наибольшая задержка первого изменения пачки
+     */
+    explicit db_writer(db_connection_pool& pool, int max_batch = 256, int max_delay_ms = 2);
+
+    /**
+     * @brief Деструктор
+     *
+     * Останавливает поток (см. stop)
+     */
+    ~db_writer();
+
+    /**
+     * @brief Остановка потока записи
+     *
+     * Выполняет изменения, оставшиеся в очереди, и дожидается завершения
+     * потока. Изменения, поставленные после остановки, сразу завершаются
+     * с результатом false
+     */
+    void stop();
+
+    /**
+     * @brief Постановка изменения в очередь
+     * @param change Изменение; выполняется в потоке записи
+     * @param done Обработчик результата; вызывается в потоке записи
+     *
+     * Может вызываться из любого потока
+     */
+    void submit(mutation change, completion done);
+
+    /**
+     * @brief Счётчики работы
+     * @return Снимок счётчиков
+     */
+    counters statistics() const;
+
+private:
+    /**
+     * @brief Изменение в очереди
+     */
+    struct pending {
+        mutation change; ///< Изменение
+        completion done; ///< Обработчик результата
+    };
+
+    db_connection_pool& pool;         ///< Пул соединений
+    int max_batch;                    ///< Наибольший размер пачки
+    int max_delay_ms;                 ///< Наибольшая задержка пачки
+    QThread* thread;                  ///< Поток записи
+    QMutex mutex;                     ///< Защита очереди
+    QWaitCondition wake;              ///< Пробуждение потока записи
+    std::deque<pending> queue;        ///< Изменения, ожидающие записи
+    bool stopping = false;            ///< Признак остановки
+    std::atomic<quint64> writes{0};   ///< Выполненные изменения
+    std::atomic<quint64> failures{0}; ///< Неудачные изменения
+    std::atomic<quint64> batches{0};  ///< Зафиксированные пачки
+    std::atomic<int> largest{0};      ///< Наибольший размер пачки
+
+    /**
+     * @brief Цикл потока записи
+     */
+    void run();
+
+    /**
+     * @brief Выполнение пачки изменений одной транзакцией
+     * @param batch Изменения
+     */
+    void commit(QVector<pending>& batch);
+
+    db_writer(const db_writer&) = delete;            ///< Запрет копирования
+    db_writer& operator=(const db_writer&) = delete; ///< Запрет присваивания
+};
+
+#endif // DB_WRITER_H
@@ -1,29 +1,85 @@
 #include "../include/dbsingleton.h"
+#include "../include/connection_registry.h"
 #include <QSqlError>
 #include <QSqlRecord>
 #include <QDebug>
+#include <QElapsedTimer>
 
 /// Статические члены класса
 DBSingleton* DBSingleton::instance = nullptr;
 DBSingletonDestroyer DBSingleton::destroyer = DBSingletonDestroyer();
 
+/// Шаги миграции схемы: шаг i переводит базу с версии i на версию i + 1.
+/// Существующие шаги не меняются, новые добавляются в конец
+static const char* const schema_migrations[] = {
+    // 1: учётные записи студентов
+    "CREATE TABLE IF NOT EXISTS students ("
+    "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+    "login TEXT UNIQUE, "
+    "hash TEXT, "
+    "email TEXT UNIQUE, "
+    "name TEXT, "
+    "surname TEXT, "
+    "middle_name TEXT)",
+};
+
 /**
  * @brief Конструктор класса DBSingleton
+ * @param pool_size Размер пула соединений
+ * @param profile Настройки соединений SQLite
  *
- * Инициализирует подключение к SQLite базе данных и функционал сервера
+ * Создаёт пул соединений с SQLite базой данных, проверяет подключение
+ * соединением текущего потока и один раз приводит схему к текущей версии
  */
-DBSingleton::DBSingleton() {
-    db = QSqlDatabase::addDatabase("QSQLITE");
-    db.setHostName("localhost");
-    db.setDatabaseName("./tmp.db");
+DBSingleton::DBSingleton(int pool_size, const sqlite_profile& profile) {
+    pool = new db_connection_pool("./tmp.db", pool_size, profile);
     this->servers_functions = functions_for_server::get_instance();
 
-    if (!db.open()) {
+    db_connection_pool::lease connection(*pool);
+    QSqlDatabase db = connection.database();
+    if (!db.isOpen()) {
         qDebug() << "Ошибка: Не удалось подключиться к базе данных.";
     } else {
-        qDebug() << "База данных успешно подключена.";
+        migrate(db);
+        qDebug() << "База данных успешно подключена. Соединений в пуле:" << pool->size();
         qDebug() << "Таблицы в базе: " << db.tables();
     }
+
+    // Изменения учётных записей фиксируются пачками в отдельном потоке
+    writer = new db_writer(*pool);
+
+    // Письма отправляются редко, двух потоков достаточно
+    mail_senders.setMaxThreadCount(2);
+}
+
+/**
+ * @brief Приводит схему базы к текущей версии
+ * @param db Соединение
+ * @return true если все шаги выполнены
+ */
+bool DBSingleton::migrate(QSqlDatabase db) {
+    QSqlQuery query(db);
+    int current = 0;
+    if (!query.exec("PRAGMA user_version") || !db_cursor<int>(query).next(current)) {
+        qDebug() << "Ошибка чтения версии схемы:" << query.lastError().text();
+        return false;
+    }
+    query.finish();
+
+    const int latest = int(sizeof(schema_migrations) / sizeof(schema_migrations[0]));
+    for (int version = current; version < latest; version++) {
+        db.transaction();
+        // PRAGMA не принимает параметры, номер версии подставляется в текст
+        if (!query.exec(schema_migrations[version])
+            || !query.exec(QString("PRAGMA user_version = %1").arg(version + 1))) {
+            qDebug() << "Ошибка миграции схемы до версии" << version + 1 << ":" << query.lastError().text();
+            db.rollback();
+            return false;
+        }
+        db.commit();
+        qDebug() << "Схема базы данных обновлена до версии" << version + 1;
+    }
+    return true;
 }
 
 /**
@@ -32,11 +88,12 @@ DBSingleton::DBSingleton() {
  * @return true если запрос выполнен успешно, false в случае ошибки
  */
 bool DBSingleton::executeQuery(const QString& queryStr) {
-    if (!db.open()) {
+    db_connection_pool::lease connection(*pool);
+    if (!connection.database().isOpen()) {
         qDebug() << "База данных не открыта.";
         return false;
     }
-    QSqlQuery query;
+    QSqlQuery query(connection.database());
     if (!query.exec(queryStr)) {
         qDebug() << "Ошибка выполнения запроса:" << query.lastError().text();
         return false;
@@ -44,10 +101,34 @@ bool DBSingleton::executeQuery(const QString& queryStr) {
     return true;
 }
 
+/**
+ * @brief Возвращает подготовленный запрос из кэша соединения
+ * @param connection Аренда соединения
+ * @param id Идентификатор запроса
+ * @return Запрос или nullptr
+ */
+QSqlQuery* DBSingleton::statement(db_connection_pool::lease& connection, db_query id) {
+    switch (id) {
+    case db_query::COUNT_ACCOUNTS:
+        return connection.statement(int(id), "SELECT COUNT(*) FROM students WHERE login = :login OR email = :email");
+    case db_query::INSERT_ACCOUNT:
+        return connection.statement(int(id), "INSERT INTO students (login, hash, email, name, surname, middle_name) "
+                                             "VALUES (:login, :password, :email, :name, :surname, :middle_name)");
+    case db_query::CHECK_PASSWORD:
+        return connection.statement(int(id), "SELECT COUNT(*) FROM students WHERE login = :login AND hash = :password");
+    case db_query::SELECT_EMAIL:
+        return connection.statement(int(id), "SELECT email FROM students WHERE login = :login");
+    case db_query::UPDATE_PASSWORD:
+        return connection.statement(int(id), "UPDATE students SET hash = :password WHERE login = :login");
+    }
+    return nullptr;
+}
+
 /// @name Регистрация пользователей
 /// @{
 /**
  * @brief Регистрирует нового пользователя
+ * @param context Контекст запроса
  * @param login Логин пользователя
  * @param password Пароль пользователя
  * @param email Email пользователя
@@ -55,73 +136,88 @@ bool DBSingleton::executeQuery(const QString& queryStr) {
  * @param first_name Имя пользователя
  * @param middle_name Отчество пользователя
  *
- * Создает таблицу users если она не существует и добавляет нового пользователя
+ * Добавляет нового пользователя; таблица создаётся миграцией при запуске.
+ * Запись выполняется потоком db_writer, ответ отправляется после фиксации
+ * на диске
  */
-void DBSingleton::slot_register_new_account(QString login, QString password, QString email,
+void DBSingleton::slot_register_new_account(request_context context, QString login, QString password, QString email,
                                             QString last_name, QString first_name, QString middle_name)
 {
-    QSqlQuery query;
-    // Создаем таблицу если она не существует
-    if (!query.exec("CREATE TABLE IF NOT EXISTS students ("
-                    "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-                    "login TEXT UNIQUE, "
-                    "hash TEXT, "
-                    "email TEXT UNIQUE, "
-                    "name TEXT, "
-                    "surname TEXT, "
-                    "middle_name TEXT)")) {
-        qDebug() << "Ошибка создания таблицы:" << query.lastError().text();
-        emit this->register_error();
-        return;
-    }
-
-    // Проверяем существование пользователя
-    QString checkQuery = QString("SELECT COUNT(*) FROM students WHERE login = '%1' OR email = '%2'")
-                             .arg(login).arg(email);
-    QVariantList result = fetchData(checkQuery);
-
-    if (!result.isEmpty() && result.first().toInt() > 0) {
-        emit this->register_error();
-        return;
-    }
+    // Проверка и добавление выполняются в потоке записи одним изменением,
+    // поэтому одновременные регистрации с одним логином не проходят обе
+    writer->submit([=](db_connection_pool::lease& connection) {
+        // Проверяем существование пользователя
+        QSqlQuery* check = statement(connection, db_query::COUNT_ACCOUNTS);
+        if (check == nullptr) {
+            return false;
+        }
+        check->bindValue(":login", login);
+        check->bindValue(":email", email);
+        int existing = 0;
+        if (!check->exec() || !db_cursor<int>(*check).next(existing) || existing > 0) {
+            return false;
+        }
+        check->finish(); // Чтение завершается до записи
 
-    // Добавляем нового пользователя
-    query.prepare("INSERT INTO students (login, hash, email, name, surname, middle_name) "
-                  "VALUES (:login, :password, :email, :name, :surname, :middle_name)");
-    query.bindValue(":login", login);
-    query.bindValue(":password", password);
-    query.bindValue(":email", email);
-    query.bindValue(":name", first_name);
-    query.bindValue(":surname", last_name);
-    query.bindValue(":middle_name", middle_name);
-
-    if (query.exec()) {
-        emit this->register_ok();
-    } else {
-        qDebug() << "Ошибка добавления пользователя:" << query.lastError().text();
-        emit this->register_error();
-    }
+        // Добавляем нового пользователя
+        QSqlQuery* insert = statement(connection, db_query::INSERT_ACCOUNT);
+        if (insert == nullptr) {
+            return false;
+        }
+        insert->bindValue(":login", login);
+        insert->bindValue(":password", password);
+        insert->bindValue(":email", email);
+        insert->bindValue(":name", first_name);
+        insert->bindValue(":surname", last_name);
+        insert->bindValue(":middle_name", middle_name);
+        if (!insert->exec()) {
+            qDebug() << "Ошибка добавления пользователя:" << insert->lastError().text();
+            return false;
+        }
+        return true;
+    }, [context](bool added) {
+        connection_registry::reply(context, added ? "register|ok" : "register|error");
+    });
 }
 /// @}
 
 /// @name Аутентификация пользователей
 /// @{
+/**
+ * @brief Проверяет логин и пароль
+ * @param login Логин пользователя
+ * @param password Пароль пользователя
+ * @return true если учётная запись найдена
+ */
+bool DBSingleton::check_password(const QString& login, const QString& password) {
+    db_connection_pool::lease connection(*pool);
+    QSqlQuery* query = statement(connection, db_query::CHECK_PASSWORD);
+    if (query == nullptr) {
+        return false;
+    }
+    query->bindValue(":login", login);
+    query->bindValue(":password", password);
+    if (!query->exec()) {
+        qDebug() << "Ошибка выполнения запроса:" << query->lastError().text();
+        return false;
+    }
+    int matches = 0;
+    return db_cursor<int>(*query).next(matches) && matches > 0;
+}
+
 /**
  * @brief Аутентифицирует пользователя
+ * @param context Контекст запроса
  * @param login Логин пользователя
  * @param password Пароль пользователя
  *
  * Проверяет соответствие логина и пароля в базе данных
  */
-void DBSingleton::slot_auth(QString login, QString password) {
-    QString selectQuery = QString("SELECT COUNT(*) FROM students WHERE login = '%1' AND hash = '%2'")
-    .arg(login).arg(password);
-    QVariantList result = fetchData(selectQuery);
-
-    if (!result.isEmpty() && result.first().toInt() > 0) {
-        emit this->auth_ok();
+void DBSingleton::slot_auth(request_context context, QString login, QString password) {
+    if (check_password(login, password)) {
+        connection_registry::reply(context, "auth|ok");
     } else {
-        emit this->auth_error();
+        connection_registry::reply(context, "auth|error");
     }
 }
 /// @}
@@ -130,107 +226,168 @@ void DBSingleton::slot_auth(QString login, QString password) {
 /// @{
 /**
  * @brief Отправляет код подтверждения на email
+ * @param context Контекст запроса
  * @param login Логин пользователя
  * @param code Код подтверждения
+ *
+ * В потоке соединения выполняется только поиск email; письмо отправляется
+ * потоком mail_senders, так как SMTP-клиент ждёт сервер блокирующими вызовами
  */
-void DBSingleton::slot_send_code(QString login, QString code) {
-    QString checkQuery = QString("SELECT email FROM students WHERE login = '%1'").arg(login);
-    QVariantList result = fetchData(checkQuery);
+void DBSingleton::slot_send_code(request_context context, QString login, QString code) {
+    QString email;
+    {
+        db_connection_pool::lease connection(*pool);
+        QSqlQuery* query = statement(connection, db_query::SELECT_EMAIL);
+        if (query != nullptr) {
+            query->bindValue(":login", login);
+            if (query->exec()) {
+                db_cursor<QString>(*query).next(email);
+            }
+        }
+    }
 
-    if (!result.isEmpty()) {
-        QString email = result[0].toString();
-        this->servers_functions->send_email_to_client(email, code);
+    // Соединение возвращается в пул до отправки письма
+    if (!email.isEmpty()) {
+        functions_for_server* functions = this->servers_functions;
+        mail_senders.start([functions, email, code]() {
+            functions->send_email_to_client(email, code);
+        });
     } else {
-        emit this->reset_error();
+        connection_registry::reply(context, "reset|error");
     }
 }
 
 /**
  * @brief Устанавливает новый пароль пользователя
+ * @param context Контекст запроса
  * @param login Логин пользователя
  * @param password Новый пароль
+ *
+ * Отсутствие пользователя определяется по числу изменённых строк.
+ * Запись выполняется потоком db_writer, ответ отправляется после фиксации
+ * на диске
  */
-void DBSingleton::slot_new_password(QString login, QString password) {
-    QString checkQuery = QString("SELECT COUNT(*) FROM students WHERE login = '%1'").arg(login);
-    QVariantList result = fetchData(checkQuery);
-
-    if (!result.isEmpty() && result.first().toInt() > 0) {
-        QString updateQuery = QString("UPDATE students SET hash = '%1' WHERE login = '%2'")
-        .arg(password).arg(login);
-
-        if (executeQuery(updateQuery)) {
-            emit this->reset_ok();
-        } else {
-            emit this->reset_error();
+void DBSingleton::slot_new_password(request_context context, QString login, QString password) {
+    writer->submit([=](db_connection_pool::lease& connection) {
+        QSqlQuery* query = statement(connection, db_query::UPDATE_PASSWORD);
+        if (query == nullptr) {
+            return false;
         }
-    } else {
-        emit this->reset_error();
-    }
+        query->bindValue(":password", password);
+        query->bindValue(":login", login);
+        return query->exec() && query->numRowsAffected() > 0;
+    }, [context](bool updated) {
+        connection_registry::reply(context, updated ? "reset|ok" : "reset|error");
+    });
 }
 /// @}
 
 /**
- * @brief Получает данные из базы данных
- * @param queryStr SQL-запрос
- * @return Список результатов запроса
+ * @brief Замер пропускной способности авторизации
+ * @param iterations Количество проверок пароля
  */
-QVariantList DBSingleton::fetchData(const QString& queryStr) {
-    if (!db.isOpen()) {
-        qDebug() << "База данных не открыта.";
-        return QVariantList();
-    }
+void DBSingleton::benchmark_auth(int iterations) {
+    const QString login("benchmark_login");
+    const QString password("benchmark_password");
+    int found = 0;
 
-    QVariantList results;
-    QSqlQuery query;
+    // Прежняя проверка пароля (fetchData) собирала текст запроса через
+    // QString::arg и компилировала его заново на каждый вызов. fetchData
+    // больше нет, поэтому тот же запрос выполняется через fetch: чтение
+    // строк в обоих циклах идёт через db_cursor, и разница показывает
+    // цену разбора SQL против подготовленного запроса из кэша соединения
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; i++) {
+        fetch<int>(QString("SELECT COUNT(*) FROM students WHERE login = '%1' AND hash = '%2'").arg(login).arg(password),
+                   [&found](int count) { found += count > 0; });
+    }
+    double text_seconds = qMax<qint64>(1, timer.nsecsElapsed()) / 1e9;
 
-    if (query.exec(queryStr)) {
-        while (query.next()) {
-            QVariantList row;
-            for (int i = 0; i <= 6; ++i) {
-                row.append(query.value(i));
-            }
-            results.append(row);
-        }
-    } else {
-        qDebug() << "Ошибка выполнения запроса:" << query.lastError().text();
+    timer.restart();
+    for (int i = 0; i < iterations; i++) {
+        found += check_password(login, password);
     }
-    return results;
+    double prepared_seconds = qMax<qint64>(1, timer.nsecsElapsed()) / 1e9;
+
+    qDebug() << QString("DBSingleton: авторизаций в секунду: QString::arg %1, подготовленный запрос %2 (%3)")
+                    .arg(iterations / text_seconds, 0, 'f', 0)
+                    .arg(iterations / prepared_seconds, 0, 'f', 0)
+                    .arg(found);
 }
 
 /**
  * @brief Деструктор класса DBSingleton
  *
- * Закрывает соединение с базой данных
+ * Закрывает соединения с базой данных. Указатель на экземпляр обнуляется
+ * сразу, поэтому повторный вызов shutdown или разрушителя ничего не удаляет
  */
 DBSingleton::~DBSingleton() {
-    db.close();
-    qDebug() << "Соединение с базой данных закрыто.";
+    instance = nullptr;
+    const db_connection_pool::counters statistics = pool->statistics();
+    qDebug() << QString("Пул соединений: аренд %1, с ожиданием %2, среднее ожидание %3 мкс, наибольшее %4 мкс")
+                    .arg(statistics.leases)
+                    .arg(statistics.waits)
+                    .arg(statistics.waits > 0 ? statistics.total_wait_us / qint64(statistics.waits) : 0)
+                    .arg(statistics.max_wait_us);
+    // Поток записи дописывает очередь и должен остановиться до закрытия соединений
+    writer->stop();
+    const db_writer::counters writes = writer->statistics();
+    qDebug() << QString("Поток записи: изменений %1, неудачных %2, транзакций %3, наибольшая пачка %4")
+                    .arg(writes.writes)
+                    .arg(writes.failures)
+                    .arg(writes.batches)
+                    .arg(writes.largest);
+    delete writer;
+    delete pool;
+    qDebug() << "Соединения с базой данных закрыты.";
+    mail_senders.waitForDone(); // Письма дописываются до удаления functions_for_server
 }
 
 /**
  * @brief Возвращает экземпляр синглтона
+ * @param pool_size Размер пула соединений
+ * @param profile Настройки соединений SQLite
  * @return Указатель на экземпляр DBSingleton
  */
-DBSingleton* DBSingleton::getInstance() {
+DBSingleton* DBSingleton::getInstance(int pool_size, const sqlite_profile& profile) {
     if (!instance) {
-        instance = new DBSingleton();
+        instance = new DBSingleton(pool_size, profile);
         destroyer.initialize(instance);
     }
     return instance;
 }
 
 /**
- * @brief Возвращает объект базы данных
- * @return Объект QSqlDatabase
+ * @brief Завершает работу с базой данных
+ *
+ * После вызова разрушитель больше не владеет экземпляром
+ */
+void DBSingleton::shutdown() {
+    delete instance;
+    destroyer.initialize(nullptr);
+}
+
+/**
+ * @brief Отключает разрушитель от экземпляра
+ */
+void DBSingleton::detach_destroyer() {
+    destroyer.initialize(nullptr);
+}
+
+/**
+ * @brief Возвращает статистику пула соединений
+ * @return Снимок счётчиков
  */
-QSqlDatabase DBSingleton::getDatabase() {
-    return db;
+db_connection_pool::counters DBSingleton::pool_statistics() const {
+    return pool->statistics();
 }
 
 /**
  * @brief Деструктор класса DBSingletonDestroyer
  *
- * Удаляет экземпляр синглтона
+ * Удаляет экземпляр синглтона, если он не был удалён DBSingleton::shutdown
+ * и разрушитель не отключён DBSingleton::detach_destroyer
  */
 DBSingletonDestroyer::~DBSingletonDestroyer() {
     delete instance;
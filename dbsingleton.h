@@ -3,18 +3,42 @@
 
 #include <QtSql/QSqlDatabase>
 #include <QtSql/QSqlQuery>
+#include <QtSql/QSqlError>
 #include <QObject>
 #include <QDebug>
+#include <QThreadPool>
 #include <QVariantList>
 #include "functions_for_server.h"
+#include "request_context.h"
+#include "db_connection_pool.h"
+#include "db_cursor.h"
+#include "db_writer.h"
 
 class DBSingletonDestroyer; ///< Предварительное объявление класса-разрушителя
 
+/**
+ * @brief Идентификаторы подготовленных запросов DBSingleton
+ *
+ * Ключ кэша подготовленных запросов соединения (db_connection_pool::lease::statement)
+ */
+enum class db_query {
+    COUNT_ACCOUNTS,  ///< Число учётных записей с данным логином или email
+    INSERT_ACCOUNT,  ///< Добавление учётной записи
+    CHECK_PASSWORD,  ///< Число учётных записей с данными логином и паролем
+    SELECT_EMAIL,    ///< Email по логину
+    UPDATE_PASSWORD, ///< Замена пароля по логину
+};
+
 /**
  * @brief Класс Singleton для работы с базой данных
  *
  * Реализует паттерн Singleton для обеспечения единственного экземпляра
- * соединения с базой данных в приложении.
+ * доступа к базе данных в приложении. Слоты вызываются напрямую в потоках
+ * соединений, и каждый запрос выполняется на соединении своего потока,
+ * арендованном у db_connection_pool. Изменения учётных записей передаются
+ * потоку db_writer и фиксируются пачками, а письма с кодом сброса пароля
+ * отправляются потоками mail_senders, чтобы ожидание SMTP-сервера не
+ * останавливало потоки соединений.
  */
 class DBSingleton : public QObject {
     Q_OBJECT
@@ -22,97 +46,128 @@ class DBSingleton : public QObject {
 private:
     static DBSingleton* instance;       ///< Единственный экземпляр класса
     static DBSingletonDestroyer destroyer; ///< Объект-разрушитель
-    QSqlDatabase db;                    ///< Объект базы данных
+    db_connection_pool* pool;           ///< Соединения потоков с базой данных
+    db_writer* writer;                  ///< Поток записи изменений учётных записей
+    QThreadPool mail_senders;           ///< Потоки отправки писем с кодом сброса пароля
 
     functions_for_server* servers_functions; ///< Указатель на вспомогательные функции сервера
 
     /**
      * @brief Приватный конструктор
+     * @param pool_size Размер пула соединений (0 - по числу ядер)
+     * @param profile Настройки соединений SQLite
      */
-    DBSingleton();
+    DBSingleton(int pool_size, const sqlite_profile& profile);
+
+    /**
+     * @brief Приведение схемы базы к текущей версии
+     * @param db Соединение текущего потока
+     * @return true если схема актуальна
+     *
+     * Версия схемы хранится в PRAGMA user_version; каждый недостающий шаг
+     * выполняется в отдельной транзакции вместе с записью новой версии
+     */
+    static bool migrate(QSqlDatabase db);
 
     DBSingleton(const DBSingleton&) = delete; ///< Запрет копирования
     DBSingleton& operator=(const DBSingleton&) = delete; ///< Запрет присваивания
 
     friend class DBSingletonDestroyer;
 
-public:
     /**
-     * @brief Получение экземпляра Singleton
-     * @return Указатель на единственный экземпляр класса
+     * @brief Подготовленный запрос из кэша соединения
+     * @param connection Аренда соединения текущего потока
+     * @param id Идентификатор запроса
+     * @return Запрос или nullptr, если его не удалось подготовить
      */
-    static DBSingleton* getInstance();
+    static QSqlQuery* statement(db_connection_pool::lease& connection, db_query id);
 
     /**
-     * @brief Получение объекта базы данных
-     * @return Объект QSqlDatabase
+     * @brief Проверка логина и пароля
+     * @param login Логин
+     * @param password Пароль
+     * @return true если учётная запись найдена
      */
-    QSqlDatabase getDatabase();
+    bool check_password(const QString& login, const QString& password);
 
+public:
     /**
-     * @brief Деструктор
+     * @brief Получение экземпляра Singleton
+     * @param pool_size Размер пула соединений (0 - по числу ядер)
+     * @param profile Настройки соединений SQLite
+     *
+     * Параметры учитываются только при первом вызове
+     * @return Указатель на единственный экземпляр класса
      */
-    ~DBSingleton();
+    static DBSingleton* getInstance(int pool_size = 0, const sqlite_profile& profile = sqlite_profile());
 
     /**
-     * @brief Выполнение SQL-запроса
-     * @param queryStr Строка с SQL-запросом
-     * @return true если запрос выполнен успешно, false в противном случае
+     * @brief Завершение работы с базой данных
+     *
+     * Дописывает очередь потока записи, закрывает соединения и удаляет
+     * экземпляр. Вызывается MyTcpServer после остановки потоков ввода-вывода:
+     * порядок уничтожения статических объектов из разных файлов не определён,
+     * поэтому на DBSingletonDestroyer полагаться нельзя
      */
-    bool executeQuery(const QString& queryStr);
+    static void shutdown();
 
     /**
-     * @brief Получение данных из базы
-     * @param queryStr Строка с SQL-запросом
-     * @return Список значений QVariantList с результатами запроса
+     * @brief Отказ от удаления экземпляра разрушителем
+     *
+     * Вызывается, когда завершение работы берёт на себя MyTcpServer:
+     * иначе DBSingletonDestroyer, уничтоженный раньше MyTcpServerDestroyer,
+     * удалил бы экземпляр, которым ещё пользуются потоки сервера
      */
-    QVariantList fetchData(const QString& queryStr);
+    static void detach_destroyer();
 
-signals:
-    /// @name Сигналы регистрации
-    /// @{
     /**
-     * @brief Сигнал успешной регистрации
+     * @brief Статистика пула соединений
+     * @return Снимок счётчиков аренды и ожидания
      */
-    void register_ok();
+    db_connection_pool::counters pool_statistics() const;
 
     /**
-     * @brief Сигнал ошибки при регистрации
+     * @brief Деструктор
      */
-    void register_error();
-    /// @}
+    ~DBSingleton();
 
-    /// @name Сигналы авторизации
-    /// @{
     /**
-     * @brief Сигнал успешной авторизации
+     * @brief Выполнение SQL-запроса
+     * @param queryStr Строка с SQL-запросом
+     * @return true если запрос выполнен успешно, false в противном случае
      */
-    void auth_ok();
+    bool executeQuery(const QString& queryStr);
 
     /**
-     * @brief Сигнал ошибки при авторизации
+     * @brief Потоковое чтение результата запроса
+     * @tparam Columns Типы читаемых столбцов
+     * @param queryStr Строка с SQL-запросом
+     * @param callback Обработчик строки, принимающий значения столбцов
+     *        (см. db_cursor::for_each)
+     * @return Количество прочитанных строк или -1 при ошибке
+     *
+     * Пример: fetch<int, QString>("SELECT id, login FROM students",
+     * [](int id, const QString& login) { ... });
      */
-    void auth_error();
-    /// @}
+    template<typename... Columns, typename Callback>
+    int fetch(const QString& queryStr, Callback&& callback);
 
-    /// @name Сигналы сброса пароля
-    /// @{
     /**
-     * @brief Сигнал ошибки (логин не найден в БД)
+     * @brief Замер пропускной способности авторизации
+     * @param iterations Количество проверок пароля
+     *
+     * Сравнивает запрос, собранный через QString::arg и выполняемый через
+     * fetch, с подготовленным запросом из кэша соединения, и выводит
+     * число авторизаций в секунду
      */
-    void reset_error();
-
-    /**
-      * @brief Сигнал успешного сброса пароля
-      */
-    void reset_ok();
-    /// @}
+    void benchmark_auth(int iterations = 20000);
 
 public slots:
     /// @name Слоты регистрации
     /// @{
     /**
      * @brief Слот регистрации нового аккаунта
+     * @param context Контекст запроса, по которому доставляется ответ
      * @param login Логин
      * @param password Пароль
      * @param email Email
@@ -120,7 +175,7 @@ public slots:
      * @param first_name Имя
      * @param middle_name Отчество
      */
-    void slot_register_new_account(QString login, QString password, QString email,
+    void slot_register_new_account(request_context context, QString login, QString password, QString email,
                                    QString last_name, QString first_name, QString middle_name);
     /// @}
 
@@ -128,36 +183,57 @@ public slots:
     /// @{
     /**
      * @brief Слот авторизации
+     * @param context Контекст запроса, по которому доставляется ответ
      * @param login Логин
      * @param password Пароль
      */
-    void slot_auth(QString login, QString password);
+    void slot_auth(request_context context, QString login, QString password);
     /// @}
 
     /// @name Слоты сброса пароля
     /// @{
     /**
      * @brief Слот отправки кода подтверждения
+     * @param context Контекст запроса, по которому доставляется ответ
      * @param login Логин пользователя
      * @param code Код подтверждения
      */
-    void slot_send_code(QString login, QString code);
+    void slot_send_code(request_context context, QString login, QString code);
 
     /**
      * @brief Слот установки нового пароля
+     * @param context Контекст запроса, по которому доставляется ответ
      * @param login Логин пользователя
      * @param password Новый пароль
      */
-    void slot_new_password(QString login, QString password);
+    void slot_new_password(request_context context, QString login, QString password);
     /// @}
 };
 
+/**
+ * @brief Потоковое чтение результата запроса
+ * @param queryStr SQL-запрос
+ * @param callback Обработчик строки
+ * @return Количество строк или -1
+ */
+template<typename... Columns, typename Callback>
+int DBSingleton::fetch(const QString& queryStr, Callback&& callback) {
+    db_connection_pool::lease connection(*pool);
+    QSqlQuery query(connection.database());
+    query.setForwardOnly(true);
+    if (!query.exec(queryStr)) {
+        qDebug() << "Ошибка выполнения запроса:" << query.lastError().text();
+        return -1;
+    }
+    return db_cursor<Columns...>(query).for_each(std::forward<Callback>(callback));
+}
+
 /**
  * @brief Класс-разрушитель для корректного удаления Singleton
  */
 class DBSingletonDestroyer {
 private:
-    DBSingleton* instance; ///< Указатель на экземпляр Singleton
+    DBSingleton* instance = nullptr; ///< Указатель на экземпляр Singleton
 
 public:
     /**
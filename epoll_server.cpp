@@ -0,0 +1,751 @@
+#include "../include/epoll_server.h"
+#include "../include/frame_buffer.h"
+#include "../include/request_dispatcher.h"
+#include "../include/functions_for_server.h"
+#include "../include/dbsingleton.h"
+#include "../include/listen_socket.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QThread>
+#include <QVector>
+#include <unordered_map>
+
+#ifdef Q_OS_LINUX
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+extern functions_for_server* servers_functions; ///< Глобальный экземпляр функций сервера
+
+#ifdef Q_OS_LINUX
+
+/// Размер буфера одного чтения из сокета
+static const int read_chunk = 64 * 1024;
+/// Наибольший объём, читаемый из одного соединения за проход цикла реактора
+static const int read_budget = 1024 * 1024;
+/// Наибольшее число событий за один вызов epoll_wait
+static const int max_events = 256;
+/// Наибольшее число подключений, принимаемых реактором за одно пробуждение
+static const int accept_batch = 16;
+/// Период проверки тайм-аутов, мс
+static const int tick_ms = 1000;
+
+/**
+ * @brief Поток-реактор epoll_server
+ *
+ * Все поля соединений изменяются только в потоке реактора. Из других
+ * потоков вызывается лишь post, которая кладёт ответ в почтовый ящик
+ * и будит реактор через eventfd
+ */
+class epoll_server::reactor
+{
+public:
+    /**
+     * @brief Соединение реактора
+     */
+    struct connection: public reply_sink {
+        reactor* owner = nullptr;                        ///< Реактор соединения
+        int fd = -1;                                     ///< Сокет
+        request_context context;                         ///< Контекст запросов соединения
+        protocol_mode protocol = protocol_mode::UNKNOWN; ///< Согласованная версия протокола
+        QByteArray negotiation;                          ///< Начало потока до завершения согласования
+        frame_buffer incoming;                           ///< Буфер сборки кадров протокола v2
+        QByteArray outgoing;                             ///< Неотправленные ответы
+        int outgoing_offset = 0;                         ///< Начало неотправленной части outgoing
+        bool reading_paused = false;                     ///< Чтение остановлено до разгрузки очереди
+        qint64 last_activity = 0;                        ///< Время последнего чтения, мс
+        std::atomic<qint64> queued{0};                   ///< Объём неотправленных ответов
+
+        void deliver(const QByteArray& message) override {
+            owner->post(context.connection_id, message);
+        }
+
+        qint64 queued_bytes() const override {
+            return queued.load(std::memory_order_relaxed);
+        }
+    };
+
+    /**
+     * @brief Конструктор реактора
+     * @param server Сервер
+     * @param index Номер реактора
+     * @param listener Прослушивающий сокет
+     * @param owns_listener Сокет принадлежит реактору и закрывается вместе с ним
+     */
+    reactor(epoll_server* server, int index, int listener, bool owns_listener);
+
+    /**
+     * @brief Деструктор: останавливает поток и закрывает соединения
+     */
+    ~reactor();
+
+    /**
+     * @brief Проверка готовности
+     * @return true если epoll и eventfd созданы, а eventfd и прослушивающий
+     *         сокет зарегистрированы в epoll
+     */
+    bool is_valid() const;
+
+    /**
+     * @brief Передача ответа соединению реактора
+     * @param connection_id Идентификатор соединения
+     * @param message Сообщение в формате "action|payload"
+     *
+     * Может вызываться из любого потока
+     */
+    void post(quint64 connection_id, const QByteArray& message);
+
+private:
+    epoll_server* server;                                  ///< Сервер
+    int listen_fd;                                         ///< Прослушивающий сокет
+    bool owns_listener;                                    ///< Сокет открыт этим реактором
+    int epoll_fd = -1;                                     ///< Экземпляр epoll
+    int wake_fd = -1;                                      ///< eventfd для пробуждения
+    bool valid = false;                                    ///< Реактор готов к работе
+    quint32 listen_events = 0;                             ///< События прослушивающего сокета в epoll
+    bool accept_paused = false;                            ///< Сокет снят с epoll до освобождения дескрипторов
+    QThread* thread = nullptr;                             ///< Поток реактора
+    std::atomic<bool> running{true};                       ///< Признак работы
+    QMutex mailbox_mutex;                                  ///< Защита mailbox
+    QVector<QPair<quint64, QByteArray>> mailbox;           ///< Ответы из других потоков
+    std::unordered_map<int, std::unique_ptr<connection>> by_fd; ///< Соединения по сокету
+    QHash<quint64, connection*> by_id;                     ///< Соединения по идентификатору
+    request_dispatcher* dispatcher = nullptr;              ///< Разбор сообщений
+    QElapsedTimer clock;                                   ///< Часы тайм-аутов
+    QVector<int> unfinished_reads;                         ///< Сокеты, прочитанные не до EAGAIN
+
+    void run();
+    void accept_connections();
+    void pause_accepting();
+    void resume_accepting();
+    void drain_mailbox();
+    bool is_open(int fd) const;
+    void read_ready(connection* target);
+    void process(connection* target, QByteArray data);
+    void enqueue(connection* target, const QByteArray& bytes);
+    void flush(connection* target);
+    void update_queued(connection* target);
+    void check_timeouts();
+    void close_connection(connection* target);
+};
+
+/**
+ * @brief Конструктор реактора
+ * @param server Сервер
+ * @param index Номер реактора
+ * @param listener Прослушивающий сокет
+ * @param owns_listener Сокет принадлежит реактору
+ *
+ * Общий прослушивающий сокет добавляется во все реакторы с EPOLLEXCLUSIVE,
+ * поэтому о новом подключении узнаёт только один из них. Собственный сокет
+ * реактора (SO_REUSEPORT) добавляется без этого флага. Ядра до 4.5 не знают
+ * EPOLLEXCLUSIVE (EINVAL): тогда сокет добавляется без него, и о каждом
+ * подключении узнают все реакторы, но принимает его только один.
+ * Если eventfd или сокет зарегистрировать не удалось, поток не запускается
+ * и реактор считается неготовым
+ */
+epoll_server::reactor::reactor(epoll_server* server, int index, int listener, bool owns_listener)
+    : server(server), listen_fd(listener), owns_listener(owns_listener) {
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd < 0 || wake_fd < 0) {
+        return;
+    }
+
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = wake_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &event) != 0) {
+        return;
+    }
+
+    listen_events = owns_listener ? EPOLLIN : EPOLLIN | EPOLLEXCLUSIVE;
+    event.events = listen_events;
+    event.data.fd = listen_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &event) != 0) {
+        if (owns_listener || errno != EINVAL) {
+            return;
+        }
+        listen_events = EPOLLIN;
+        event.events = listen_events;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &event) != 0) {
+            return;
+        }
+    }
+    valid = true;
+
+    clock.start();
+    thread = QThread::create([this]() { run(); });
+    thread->setObjectName(QString("epoll_reactor_%1").arg(index));
+    thread->start();
+}
+
+/**
+ * @brief Деструктор реактора
+ */
+epoll_server::reactor::~reactor() {
+    if (thread != nullptr) {
+        running.store(false);
+        const quint64 one = 1;
+        ssize_t ignored = write(wake_fd, &one, sizeof(one));
+        Q_UNUSED(ignored);
+        thread->wait();
+        delete thread;
+    }
+
+    while (!by_fd.empty()) {
+        close_connection(by_fd.begin()->second.get());
+    }
+    if (owns_listener) {
+        listen_socket::close(listen_fd);
+    }
+    if (wake_fd >= 0) {
+        ::close(wake_fd);
+    }
+    if (epoll_fd >= 0) {
+        ::close(epoll_fd);
+    }
+}
+
+/**
+ * @brief Проверка готовности
+ * @return true если реактор создан и его поток запущен
+ */
+bool epoll_server::reactor::is_valid() const {
+    return valid;
+}
+
+/**
+ * @brief Передача ответа соединению реактора
+ * @param connection_id Идентификатор соединения
+ * @param message Сообщение
+ *
+ * Реактор будится только при первом ответе в пустом почтовом ящике
+ */
+void epoll_server::reactor::post(quint64 connection_id, const QByteArray& message) {
+    bool wake;
+    {
+        QMutexLocker locker(&mailbox_mutex);
+        wake = mailbox.isEmpty();
+        mailbox.push_back(qMakePair(connection_id, message));
+    }
+    if (wake) {
+        const quint64 one = 1;
+        ssize_t ignored = write(wake_fd, &one, sizeof(one));
+        Q_UNUSED(ignored);
+    }
+}
+
+/**
+ * @brief Цикл реактора
+ */
+void epoll_server::reactor::run() {
+    request_dispatcher local_dispatcher;
+    dispatcher = &local_dispatcher;
+
+    epoll_event events[max_events];
+    qint64 next_tick = clock.elapsed() + tick_ms;
+    while (running.load()) {
+        // Пока есть недочитанные сокеты, epoll_wait не ждёт новых событий
+        const int count = epoll_wait(epoll_fd, events, max_events, unfinished_reads.isEmpty() ? tick_ms : 0);
+        for (int i = 0; i < count; i++) {
+            const int fd = events[i].data.fd;
+            if (fd == wake_fd) {
+                quint64 value;
+                ssize_t ignored = read(wake_fd, &value, sizeof(value));
+                Q_UNUSED(ignored);
+                drain_mailbox();
+                continue;
+            }
+            if (fd == listen_fd) {
+                accept_connections();
+                continue;
+            }
+
+            auto found = by_fd.find(fd);
+            if (found == by_fd.end()) {
+                continue;
+            }
+            connection* target = found->second.get();
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                close_connection(target);
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) {
+                flush(target);
+                if (!is_open(fd)) {
+                    continue;
+                }
+            }
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP)) {
+                read_ready(target);
+            }
+        }
+
+        // Соединения, исчерпавшие read_budget, дочитываются после остальных
+        QVector<int> unfinished;
+        unfinished.swap(unfinished_reads);
+        for (int fd : unfinished) {
+            auto found = by_fd.find(fd);
+            if (found != by_fd.end()) {
+                read_ready(found->second.get());
+            }
+        }
+
+        if (clock.elapsed() >= next_tick) {
+            resume_accepting();
+            check_timeouts();
+            next_tick = clock.elapsed() + tick_ms;
+        }
+    }
+    dispatcher = nullptr;
+}
+
+/**
+ * @brief Приём новых подключений
+ *
+ * Сверх предела max_connections подключение получает сообщение busy
+ * и закрывается; уже подключённые клиенты при этом не затрагиваются.
+ * Если у процесса кончились дескрипторы, подключение остаётся в очереди
+ * сокета, и приём приостанавливается до освобождения дескриптора
+ */
+void epoll_server::reactor::accept_connections() {
+    for (int i = 0; i < accept_batch; i++) {
+        const int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EMFILE || errno == ENFILE) {
+                pause_accepting();
+            }
+            return;
+        }
+
+        if (server->active.fetch_add(1) >= server->max_connections) {
+            server->active.fetch_sub(1);
+            server->refused.fetch_add(1, std::memory_order_relaxed);
+            if (!server->saturated.exchange(true)) {
+                qDebug() << QString("%1 Достигнут предел подключений (%2), новые подключения отклоняются")
+                                .arg(servers_functions->get_server_time())
+                                .arg(server->max_connections);
+            }
+            ssize_t ignored = send(fd, frame_buffer::busy.constData(), frame_buffer::busy.size(), MSG_NOSIGNAL);
+            Q_UNUSED(ignored);
+            ::close(fd);
+            continue;
+        }
+
+        auto created = std::make_unique<connection>();
+        connection* target = created.get();
+        target->owner = this;
+        target->fd = fd;
+        target->last_activity = clock.elapsed();
+        target->context.connection_id = connection_registry::add(target);
+        by_id.insert(target->context.connection_id, target);
+        by_fd[fd] = std::move(created);
+
+        epoll_event event = {};
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.fd = fd;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            const int error = errno;
+            qDebug() << QString("%1 Не удалось добавить клиента в epoll: %2")
+                            .arg(servers_functions->get_server_time())
+                            .arg(error);
+            close_connection(target);
+        }
+    }
+}
+
+/**
+ * @brief Приостановка приёма подключений
+ *
+ * Прослушивающий сокет отслеживается в режиме level-triggered: пока
+ * accept4 завершается с EMFILE или ENFILE, он остаётся готовым к чтению,
+ * и epoll_wait возвращался бы сразу, занимая ядро целиком. Поэтому сокет
+ * снимается с epoll до закрытия соединения или следующего тика
+ */
+void epoll_server::reactor::pause_accepting() {
+    if (accept_paused) {
+        return;
+    }
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, listen_fd, nullptr);
+    accept_paused = true;
+    qDebug() << QString("%1 Закончились файловые дескрипторы, приём подключений приостановлен")
+                    .arg(servers_functions->get_server_time());
+}
+
+/**
+ * @brief Возобновление приёма подключений после pause_accepting
+ */
+void epoll_server::reactor::resume_accepting() {
+    if (!accept_paused) {
+        return;
+    }
+    epoll_event event = {};
+    event.events = listen_events;
+    event.data.fd = listen_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &event) == 0) {
+        accept_paused = false;
+    }
+}
+
+/**
+ * @brief Перенос ответов из почтового ящика в очереди соединений
+ *
+ * Ответы, пришедшие за одно пробуждение, отправляются одной записью
+ * на каждое соединение
+ */
+void epoll_server::reactor::drain_mailbox() {
+    QVector<QPair<quint64, QByteArray>> messages;
+    {
+        QMutexLocker locker(&mailbox_mutex);
+        messages.swap(mailbox);
+    }
+
+    QVector<connection*> touched;
+    for (const auto& message : messages) {
+        connection* target = by_id.value(message.first, nullptr);
+        if (target == nullptr) {
+            continue;
+        }
+        if (target->outgoing.size() == target->outgoing_offset) {
+            touched.push_back(target);
+        }
+        enqueue(target, target->protocol == protocol_mode::FRAMED ? frame_buffer::pack(message.second)
+                                                                  : message.second);
+    }
+    for (connection* target : touched) {
+        // Соединение могло быть закрыто при отправке предыдущему
+        if (by_id.contains(target->context.connection_id) && by_id.value(target->context.connection_id) == target) {
+            flush(target);
+        }
+    }
+}
+
+/**
+ * @brief Проверка, что соединение ещё открыто
+ * @param fd Сокет соединения
+ * @return true если соединение не закрыто
+ */
+bool epoll_server::reactor::is_open(int fd) const {
+    return by_fd.find(fd) != by_fd.end();
+}
+
+/**
+ * @brief Чтение доступных данных соединения
+ * @param target Соединение
+ *
+ * В режиме edge-triggered сокет читается до EAGAIN. Если за один проход
+ * прочитано больше read_budget, соединение дочитывается на следующем
+ * проходе, чтобы один клиент не задерживал остальных
+ */
+void epoll_server::reactor::read_ready(connection* target) {
+    if (target->reading_paused) {
+        return;
+    }
+
+    const int fd = target->fd;
+    QByteArray data;
+    char buffer[read_chunk];
+    bool closed = false;
+    while (true) {
+        if (data.size() >= read_budget) {
+            unfinished_reads.push_back(fd);
+            break;
+        }
+        const ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received > 0) {
+            data.append(buffer, int(received));
+            continue;
+        }
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        // Соединение закрыто клиентом или произошла ошибка
+        closed = true;
+        break;
+    }
+
+    if (!data.isEmpty()) {
+        target->last_activity = clock.elapsed();
+        process(target, data);
+    }
+    if (!is_open(fd)) {
+        return;
+    }
+    if (closed) {
+        close_connection(target);
+    } else if (target->outgoing.size() > target->outgoing_offset) {
+        flush(target);
+    }
+}
+
+/**
+ * @brief Обработка принятых данных
+ * @param target Соединение
+ * @param data Принятые байты
+ *
+ * Согласование протокола и сборка кадров выполняются так же, как в client
+ */
+void epoll_server::reactor::process(connection* target, QByteArray data) {
+    if (target->protocol == protocol_mode::UNKNOWN) {
+        target->negotiation.append(data);
+        if (target->negotiation.startsWith(frame_buffer::handshake)) {
+            target->protocol = protocol_mode::FRAMED;
+            data = target->negotiation.mid(frame_buffer::handshake.size());
+            enqueue(target, frame_buffer::handshake);
+        }
+        else if (frame_buffer::handshake.startsWith(target->negotiation)) {
+            return; // Строка согласования пришла не полностью
+        }
+        else {
+            target->protocol = protocol_mode::LEGACY;
+            data = target->negotiation;
+        }
+        target->negotiation.clear();
+        target->context.protocol = target->protocol;
+    }
+
+    if (target->protocol == protocol_mode::LEGACY) {
+        dispatcher->dispatch(target->context, data);
+        return;
+    }
+
+    target->incoming.append(data);
+    QByteArray frame;
+    while (target->incoming.next(frame)) {
+        dispatcher->dispatch(target->context, frame);
+    }
+    if (target->incoming.is_broken()) {
+        qDebug() << QString("%1 Клиент ").arg(servers_functions->get_server_time())
+                 << target->context.connection_id
+                 << " прислал кадр недопустимого размера, соединение закрыто";
+        close_connection(target);
+    }
+}
+
+/**
+ * @brief Добавление байтов в очередь ответов
+ * @param target Соединение
+ * @param bytes Данные для отправки
+ */
+void epoll_server::reactor::enqueue(connection* target, const QByteArray& bytes) {
+    target->outgoing.append(bytes);
+    update_queued(target);
+}
+
+/**
+ * @brief Отправка очереди ответов до EAGAIN
+ * @param target Соединение
+ */
+void epoll_server::reactor::flush(connection* target) {
+    while (target->outgoing_offset < target->outgoing.size()) {
+        const ssize_t sent = send(target->fd, target->outgoing.constData() + target->outgoing_offset,
+                                  target->outgoing.size() - target->outgoing_offset, MSG_NOSIGNAL);
+        if (sent > 0) {
+            target->outgoing_offset += int(sent);
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break; // Продолжим по EPOLLOUT
+        }
+        close_connection(target);
+        return;
+    }
+
+    // Переданная часть удаляется целиком или когда она занимает больше половины буфера
+    if (target->outgoing_offset == target->outgoing.size()) {
+        target->outgoing.clear();
+        target->outgoing_offset = 0;
+    } else if (target->outgoing_offset > target->outgoing.size() / 2) {
+        target->outgoing.remove(0, target->outgoing_offset);
+        target->outgoing_offset = 0;
+    }
+    update_queued(target);
+}
+
+/**
+ * @brief Пересчёт объёма очереди и управление чтением
+ * @param target Соединение
+ */
+void epoll_server::reactor::update_queued(connection* target) {
+    const qint64 total = target->outgoing.size() - target->outgoing_offset;
+    target->queued.store(total, std::memory_order_relaxed);
+
+    if (!target->reading_paused && total > reply_sink::high_water_mark) {
+        target->reading_paused = true;
+        qDebug() << QString("%1 Клиент ").arg(servers_functions->get_server_time())
+                 << target->context.connection_id
+                 << QString(" не успевает принимать ответы (%1 байт в очереди), чтение приостановлено").arg(total);
+    } else if (target->reading_paused && total < reply_sink::low_water_mark) {
+        target->reading_paused = false;
+        qDebug() << QString("%1 Клиент ").arg(servers_functions->get_server_time())
+                 << target->context.connection_id
+                 << QString(" разгрузил очередь ответов (%1 байт), чтение возобновлено").arg(total);
+        // Новых событий EPOLLIN для уже пришедших данных не будет
+        unfinished_reads.push_back(target->fd);
+    }
+}
+
+/**
+ * @brief Закрытие соединений с истёкшими тайм-аутами
+ *
+ * Соединение с неотправленными ответами или приостановленным чтением
+ * не считается простаивающим
+ */
+void epoll_server::reactor::check_timeouts() {
+    const qint64 now = clock.elapsed();
+    QVector<connection*> expired;
+    for (const auto& entry : by_fd) {
+        connection* target = entry.second.get();
+        const bool partial = target->protocol == protocol_mode::UNKNOWN ? !target->negotiation.isEmpty()
+                                                                        : target->incoming.pending() > 0;
+        const int interval = partial ? server->timeouts.read_ms : server->timeouts.idle_ms;
+        if (interval <= 0 || now - target->last_activity < interval) {
+            continue;
+        }
+        if (!partial && (target->reading_paused || target->queued_bytes() > 0)) {
+            target->last_activity = now;
+            continue;
+        }
+        qDebug() << QString("%1 Клиент ").arg(servers_functions->get_server_time())
+                 << target->context.connection_id
+                 << (partial ? QString(" не закончил передачу сообщения за %1 мс, соединение закрыто").arg(interval)
+                             : QString(" бездействовал %1 мс, соединение закрыто").arg(interval));
+        expired.push_back(target);
+    }
+    for (connection* target : expired) {
+        close_connection(target);
+    }
+}
+
+/**
+ * @brief Закрытие соединения
+ * @param target Соединение
+ *
+ * Соединение удаляется из connection_registry до освобождения памяти,
+ * поэтому ответы, пришедшие позже, отбрасываются
+ */
+void epoll_server::reactor::close_connection(connection* target) {
+    const int fd = target->fd;
+    connection_registry::remove(target->context.connection_id);
+    by_id.remove(target->context.connection_id);
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    by_fd.erase(fd);
+    resume_accepting();
+
+    if (server->active.fetch_sub(1) - 1 < server->max_connections && server->saturated.exchange(false)) {
+        qDebug() << QString("%1 Число подключений ниже предела, приём возобновлён. Отклонено: %2")
+                        .arg(servers_functions->get_server_time())
+                        .arg(server->refused.load(std::memory_order_relaxed));
+    }
+}
+
+/**
+ * @brief Конструктор сервера
+ * @param port Порт
+ * @param threads Количество реакторов
+ * @param max_connections Наибольшее число подключений
+ * @param timeouts Тайм-ауты подключений
+ * @param reuse_port Отдельный сокет у каждого реактора
+ */
+epoll_server::epoll_server(quint16 port, int threads, int max_connections, const connection_timeouts& timeouts,
+                           bool reuse_port)
+    : max_connections(qMax(1, max_connections)), timeouts(timeouts) {
+    if (threads <= 0) {
+        threads = qMax(1, QThread::idealThreadCount());
+    }
+
+    // Объект базы данных создаётся до запуска реакторов: getInstance
+    // не рассчитан на одновременный вызов из нескольких потоков
+    DBSingleton::getInstance(threads);
+
+    if (!reuse_port) {
+        listen_fd = int(listen_socket::open(port, false));
+        if (listen_fd < 0) {
+            return;
+        }
+    } else if (!listen_socket::port_available(port)) {
+        // Сокет с SO_REUSEPORT открылся бы и рядом с другим экземпляром
+        // сервера того же пользователя, разделив с ним подключения
+        qDebug() << QString("%1 Порт %2 уже занят другим процессом")
+                        .arg(servers_functions->get_server_time())
+                        .arg(port);
+        return;
+    }
+
+    for (int i = 0; i < threads; i++) {
+        const int listener = reuse_port ? int(listen_socket::open(port, true)) : listen_fd;
+        std::unique_ptr<reactor> created;
+        if (listener >= 0) {
+            created = std::make_unique<reactor>(this, i, listener, reuse_port);
+        }
+        if (created == nullptr || !created->is_valid()) {
+            // Собственный сокет реактора закрывает его деструктор, общий
+            // сокет совпадает с listen_fd и закрывается один раз ниже
+            reactors.clear();
+            listen_socket::close(listen_fd);
+            listen_fd = -1;
+            return;
+        }
+        reactors.push_back(std::move(created));
+    }
+}
+
+/**
+ * @brief Деструктор сервера
+ */
+epoll_server::~epoll_server() {
+    reactors.clear();
+    listen_socket::close(listen_fd);
+}
+
+#else // Q_OS_LINUX
+
+/// Вне Linux epoll недоступен: сервер не запускается, is_listening() возвращает false
+class epoll_server::reactor {};
+
+epoll_server::epoll_server(quint16, int, int max_connections, const connection_timeouts& timeouts, bool)
+    : max_connections(max_connections), timeouts(timeouts) {
+}
+
+epoll_server::~epoll_server() {
+}
+
+#endif // Q_OS_LINUX
+
+/**
+ * @brief Проверка запуска
+ * @return true если сервер принимает подключения
+ */
+bool epoll_server::is_listening() const {
+    return !reactors.empty();
+}
+
+/**
+ * @brief Количество потоков-реакторов
+ * @return Число реакторов
+ */
+int epoll_server::size() const {
+    return int(reactors.size());
+}
+
+/**
+ * @brief Количество отклонённых подключений
+ * @return Число подключений сверх предела
+ */
+quint64 epoll_server::refused_connections() const {
+    return refused.load(std::memory_order_relaxed);
+}
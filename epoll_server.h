@@ -0,0 +1,79 @@
+#ifndef EPOLL_SERVER_H
+#define EPOLL_SERVER_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "connection_registry.h"
+
+/**
+ * @brief Сетевая подсистема на epoll (только Linux)
+ *
+ * Альтернатива QTcpServer и объекту client на каждое соединение. Каждый
+ * поток-реактор ведёт собственный экземпляр epoll и обслуживает
+ * неблокирующие сокеты в режиме edge-triggered без цикла событий Qt.
+ * Подключения принимаются из общего прослушивающего сокета (EPOLLEXCLUSIVE)
+ * или, с reuse_port, каждый реактор открывает собственный сокет с SO_REUSEPORT.
+ * Сообщения разбирает тот же request_dispatcher, ответы приходят через
+ * connection_registry и передаются реактору соединения через eventfd.
+ * Протокол, очередь ответов с порогами high/low water, тайм-ауты
+ * и предел подключений ведут себя так же, как в client и MyTcpServer
+ */
+class epoll_server
+{
+public:
+    /**
+     * @brief Конструктор сервера
+     * @param port Порт для прослушивания
+     * @param threads Количество потоков-реакторов (0 - по числу ядер)
+     * @param max_connections Наибольшее число одновременных подключений
+     * @param timeouts Тайм-ауты подключений
+     * @param reuse_port Отдельный прослушивающий сокет у каждого реактора
+     *
+     * Открывает порт и запускает реакторы. При ошибке is_listening()
+     * возвращает false
+     */
+    epoll_server(quint16 port, int threads, int max_connections, const connection_timeouts& timeouts,
+                 bool reuse_port = false);
+
+    /**
+     * @brief Деструктор
+     *
+     * Останавливает реакторы и закрывает все соединения
+     */
+    ~epoll_server();
+
+    /**
+     * @brief Проверка запуска
+     * @return true если порт открыт и реакторы запущены
+     */
+    bool is_listening() const;
+
+    /**
+     * @brief Количество потоков-реакторов
+     * @return Число реакторов
+     */
+    int size() const;
+
+    /**
+     * @brief Количество отклонённых подключений
+     * @return Подключения сверх предела с момента запуска
+     */
+    quint64 refused_connections() const;
+
+private:
+    class reactor;
+
+    int listen_fd = -1;                             ///< Общий прослушивающий сокет (без reuse_port)
+    std::vector<std::unique_ptr<reactor>> reactors; ///< Потоки-реакторы
+    int max_connections;                            ///< Наибольшее число одновременных подключений
+    connection_timeouts timeouts;                   ///< Тайм-ауты подключений
+    std::atomic<int> active{0};                     ///< Текущее число подключений
+    std::atomic<quint64> refused{0};                ///< Число отклонённых подключений
+    std::atomic<bool> saturated{false};             ///< Предел подключений достигнут
+
+    epoll_server(const epoll_server&) = delete; ///< Запрет копирования
+};
+
+#endif // EPOLL_SERVER_H
@@ -0,0 +1,83 @@
+#include "../include/frame_buffer.h"
+#include <QtEndian>
+#include <cstring>
+
+/// Статические члены класса
+const QByteArray frame_buffer::handshake = QByteArray("proto|2\n");
+const QByteArray frame_buffer::busy = QByteArray("busy|Сервер перегружен, повторите попытку позже");
+
+/**
+ * @brief Упаковывает сообщение в кадр протокола v2
+ * @param payload Сообщение
+ * @return Кадр с 4-байтовым заголовком длины
+ */
+QByteArray frame_buffer::pack(const QByteArray& payload) {
+    QByteArray frame(header_size + payload.size(), Qt::Uninitialized);
+    qToBigEndian<quint32>(quint32(payload.size()), frame.data());
+    memcpy(frame.data() + header_size, payload.constData(), size_t(payload.size()));
+    return frame;
+}
+
+/**
+ * @brief Добавляет принятые байты в буфер
+ * @param data Данные из сокета
+ *
+ * Уже обработанная часть буфера отбрасывается перед добавлением,
+ * чтобы буфер не рос при длительной работе соединения
+ */
+void frame_buffer::append(const QByteArray& data) {
+    if (offset > 0) {
+        buffer.remove(0, offset);
+        offset = 0;
+    }
+    buffer.append(data);
+}
+
+/**
+ * @brief Извлекает очередной полный кадр
+ * @param payload Нагрузка кадра
+ * @return true если кадр извлечён
+ */
+bool frame_buffer::next(QByteArray& payload) {
+    if (broken || buffer.size() - offset < header_size) {
+        return false;
+    }
+
+    quint32 length = qFromBigEndian<quint32>(buffer.constData() + offset);
+    if (length > quint32(max_frame_size)) {
+        broken = true;
+        return false;
+    }
+    if (buffer.size() - offset - header_size < int(length)) {
+        return false;
+    }
+
+    payload = buffer.mid(offset + header_size, int(length));
+    offset += header_size + int(length);
+    return true;
+}
+
+/**
+ * @brief Проверяет, был ли получен некорректный заголовок
+ * @return true если поток повреждён
+ */
+bool frame_buffer::is_broken() const {
+    return broken;
+}
+
+/**
+ * @brief Возвращает количество несобранных байтов
+ * @return Размер остатка
+ */
+int frame_buffer::pending() const {
+    return buffer.size() - offset;
+}
+
+/**
+ * @brief Очищает буфер
+ */
+void frame_buffer::clear() {
+    buffer.clear();
+    offset = 0;
+    broken = false;
+}
@@ -0,0 +1,84 @@
+#ifndef FRAME_BUFFER_H
+#define FRAME_BUFFER_H
+
+#include <QByteArray>
+
+/**
+ * @brief Версия протокола, согласованная для соединения
+ */
+enum class protocol_mode {
+    UNKNOWN, ///< Согласование ещё не завершено
+    LEGACY,  ///< Текстовый формат "action|payload" без границ сообщений
+    FRAMED,  ///< Протокол v2: каждое сообщение предваряется длиной
+};
+
+/**
+ * @brief Буфер сборки сообщений протокола v2
+ *
+ * Кадр протокола v2 состоит из 4-байтового заголовка с длиной полезной
+ * нагрузки (big-endian) и самой нагрузки в прежнем формате "action|payload".
+ * Буфер накапливает поступающие байты соединения и выдаёт полностью
+ * принятые кадры; неполный кадр остаётся в буфере до следующего чтения.
+ *
+ * Для перехода на v2 клиент сразу после подключения отправляет строку
+ * handshake, сервер отвечает той же строкой. Если ответа нет, клиент
+ * продолжает работать в текстовом формате.
+ *
+ * Сообщение busy отправляется текстом, а не кадром: сервер отказывает в
+ * подключении сразу после accept, не дожидаясь строки согласования, и ещё
+ * не знает версию протокола клиента. Клиент v2, получив вместо handshake
+ * другие байты, переходит на текстовый формат и разбирает busy как
+ * обычное сообщение, поэтому ответ понятен клиентам обеих версий.
+ */
+class frame_buffer
+{
+public:
+    static const QByteArray handshake;      ///< Строка согласования протокола v2
+    static const QByteArray busy;           ///< Ответ на подключение сверх предела сервера (всегда текстом)
+    static const int header_size = 4;       ///< Размер заголовка кадра
+    static const int max_frame_size = 16 * 1024 * 1024; ///< Максимальный размер нагрузки кадра
+
+    /**
+     * @brief Упаковка сообщения в кадр
+     * @param payload Сообщение
+     * @return Кадр с заголовком длины
+     */
+    static QByteArray pack(const QByteArray& payload);
+
+    /**
+     * @brief Добавление принятых байтов
+     * @param data Данные, прочитанные из сокета
+     */
+    void append(const QByteArray& data);
+
+    /**
+     * @brief Извлечение очередного полного кадра
+     * @param payload Нагрузка извлечённого кадра
+     * @return true если кадр извлечён, false если данных недостаточно
+     */
+    bool next(QByteArray& payload);
+
+    /**
+     * @brief Проверка на превышение допустимого размера кадра
+     * @return true если поток данных повреждён и соединение следует закрыть
+     */
+    bool is_broken() const;
+
+    /**
+     * @brief Количество байтов, ожидающих сборки
+     * @return Размер необработанного остатка
+     */
+    int pending() const;
+
+    /**
+     * @brief Очистка буфера
+     */
+    void clear();
+
+private:
+    QByteArray buffer;   ///< Накопленные байты
+    int offset = 0;      ///< Начало необработанных данных в буфере
+    bool broken = false; ///< Признак некорректного заголовка
+};
+
+#endif // FRAME_BUFFER_H
@@ -1,5 +1,12 @@
 #include "../include/functions_for_server.h"
+#include "../include/connection_registry.h"
+#include "../include/grid_kernel.h"
+#include "../include/quadratic_batch.h"
 #include <QDebug>
+#include <QStringList>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include "../libraries/SMTPEmail/include/SmtpMime"
 
 /// Статический член класса
@@ -10,6 +17,50 @@ functions_for_server* functions_for_server::p_instance = nullptr;
  */
 functions_for_server::functions_for_server(){}
 
+/**
+ * @brief Деструктор класса functions_for_server
+ */
+functions_for_server::~functions_for_server() {
+    delete solver_pool;
+    delete cache;
+}
+
+/**
+ * @brief Запускает пул потоков решателя
+ * @param threads Количество потоков (0 - по числу ядер процессора)
+ */
+void functions_for_server::start_solver_pool(int threads) {
+    if (solver_pool == nullptr) {
+        solver_pool = new compute_pool(threads);
+    }
+}
+
+/**
+ * @brief Включает кэш готовых ответов
+ * @param budget Бюджет памяти в байтах
+ */
+void functions_for_server::start_result_cache(qint64 budget) {
+    if (cache == nullptr && budget > 0) {
+        cache = new result_cache(budget);
+    }
+}
+
+/**
+ * @brief Возвращает счётчики кэша
+ * @return Снимок счётчиков
+ */
+result_cache::counters functions_for_server::cache_statistics() const {
+    return cache ? cache->statistics() : result_cache::counters();
+}
+
+/**
+ * @brief Возвращает количество присоединённых запросов
+ * @return Значение счётчика
+ */
+quint64 functions_for_server::coalesced_requests() const {
+    return coalesced.load(std::memory_order_relaxed);
+}
+
 /**
  * @brief Отправляет email с кодом подтверждения
  * @param email Адрес электронной почты
@@ -80,95 +131,172 @@ QString functions_for_server::get_server_time() {
     return QString(time_format);
 }
 
+/// Границы относительной точности, которую может запросить клиент
+static const double min_tolerance = 1e-15;
+static const double max_tolerance = 1e-3;
+/// Количество интервалов грубой сетки
+static const qint64 coarse_intervals = 1024;
+/// Наибольшая степень многочлена в запросе
+static const int max_polynomial_degree = 64;
+
 /**
- * @brief Генерирует диапазоны значений
- * @param a Начальное значение
- * @param b Конечное значение
- * @param step Шаг
- * @return Вектор диапазонов
+ * @brief Сортирует корни и объединяет совпадающие
+ * @param roots Корни
+ * @param tolerance Относительная точность корней
+ * @param scale Наибольший модуль точки отрезка поиска
+ *
+ * Простые корни уточняются на непересекающихся отрезках, поэтому повтором
+ * считается только корень, отличающийся не больше чем на ошибку
+ * представления узла сетки 4ε·scale. Корень касания кратности m может
+ * попасть в ответ и из узла сетки, и из критической точки: значение
+ * многочлена не отличается от нуля на расстоянии порядка ε^(1/m)·|x|, а
+ * критическая точка уточняется с точностью одного отрезка tolerance·|x|.
+ * Поэтому два кратных корня объединяются на расстоянии не больше
+ * ε^(1/m)·|x| + tolerance·|x|. Радиус для простых корней не зависит от
+ * точности, запрошенной клиентом, и различимые корни не объединяются.
+ * У объединённого корня остаётся наибольшая кратность
  */
-QVector<QPair<double, double>> functions_for_server::diaposons(double a, double b, double step) {
-    QVector<QPair<double, double>> diaposon;
-    for (double x = a; x < b; x += step) {
-        diaposon.push_back({x, x + step});
+static void merge_roots(QVector<polynomial::root>& roots, double tolerance, double scale) {
+    std::sort(roots.begin(), roots.end(), [](const polynomial::root& left, const polynomial::root& right) {
+        return left.value < right.value;
+    });
+
+    const double epsilon = std::numeric_limits<double>::epsilon();
+    const double absolute = 4 * epsilon * scale;
+    int kept = 0;
+    for (int i = 0; i < roots.size(); i++) {
+        if (kept > 0) {
+            polynomial::root& last = roots[kept - 1];
+            double limit = absolute;
+            const int multiplicity = std::min(last.multiplicity, roots[i].multiplicity);
+            if (multiplicity > 1) {
+                const double magnitude = std::max({1.0, std::abs(last.value), std::abs(roots[i].value)});
+                limit += (std::pow(epsilon, 1.0 / multiplicity) + tolerance) * magnitude;
+            }
+            if (roots[i].value - last.value <= limit) {
+                last.multiplicity = std::max(last.multiplicity, roots[i].multiplicity);
+                continue;
+            }
+        }
+        roots[kept++] = roots[i];
     }
-    return diaposon;
+    roots.resize(kept);
 }
 
 /**
- * @brief Находит корни уравнения на заданных интервалах
- * @param diapozon Вектор интервалов поиска
+ * @brief Вычисляет границу модулей корней многочлена
+ * @param coefficients Коэффициенты, начиная со старшей степени
+ * @return Граница R
+ */
+double functions_for_server::root_bound(const QVector<double>& coefficients) {
+    return polynomial(coefficients).root_bound();
+}
+
+/**
+ * @brief Находит корни уравнения на сетке
+ * @param from Начало отрезка поиска
+ * @param to Конец отрезка поиска
+ * @param step Наименьший шаг сетки
  * @param a Коэффициент a
  * @param b Коэффициент b
  * @param c Коэффициент c
+ * @param options Параметры решения
+ * @param stats Счётчики затрат (может быть nullptr)
  * @return Вектор найденных корней
+ *
+ * Узлы сетки вычисляются как from + i·width векторизованным ядром
+ * grid_kernel блоками по grid_kernel::block_size интервалов, значение в каждом
+ * узле вычисляется один раз. Интервал, внутри которого лежит критическая точка,
+ * делится ею на части; значение в ней, не превышающее ошибки округления,
+ * означает корень касания, кратность которого берётся из polynomial::tangent_roots
  */
-QVector<double> functions_for_server::find_x(const QVector<QPair<double, double>>& diapozon,
-                                             double a, double b, double c) {
-    QVector<double> answers;
-    const double eps = 1e-8;
-    const double zero_eps = 1e-10;
-
-    auto isZero = [zero_eps](double val) {
-        return std::abs(val) < zero_eps;
-    };
-
-    for (auto interval : diapozon) {
-        double left = interval.first;
-        double right = interval.second;
-        double f_left = Calc(a, b, c, left);
-        double f_right = Calc(a, b, c, right);
+QVector<polynomial::root> functions_for_server::find_x(double from, double to, double step,
+                                                       double a, double b, double c,
+                                                       const solver_options& options,
+                                                       polynomial::statistics* stats) {
+    QVector<polynomial::root> answers;
+
+    if (!(step > 0) || !(to > from)) {
+        return answers;
+    }
 
-        // Проверка корней на границах
-        if (isZero(f_left)) {
-            answers.push_back(left);
-            continue;
-        }
-        if (isZero(f_right)) {
-            answers.push_back(right);
-            continue;
-        }
+    polynomial::statistics local;
+    polynomial::statistics& counters = stats ? *stats : local;
+    const polynomial equation({a, b, c});
+    const QVector<double> critical = equation.critical_points(options.tolerance, &counters);
+    const QVector<polynomial::root> tangents = equation.tangent_roots(options.tolerance, &counters);
+
+    const qint64 intervals = qBound<qint64>(1, qint64(std::ceil((to - from) / step)), coarse_intervals);
+    const double width = (to - from) / double(intervals);
+    counters.evaluations += int(intervals) + 1;
+
+    // Значения в узлах блока; values[0] - последний узел предыдущего блока
+    double values[grid_kernel::block_size + 1];
+    grid_kernel::evaluate(a, b, c, from, width, 0, 1, values);
+    bool left_is_root = std::abs(values[0]) <= equation.rounding_error(from);
+    if (left_is_root) {
+        answers.push_back({from, polynomial::multiplicity(tangents, from, options.tolerance)});
+    }
 
-        // Поиск корня методом бисекции
-        if (f_left * f_right <= 0 || std::min(std::abs(f_left), std::abs(f_right)) < zero_eps) {
-            while (std::abs(right - left) > eps) {
-                double mid = (left + right) / 2;
-                double f_mid = Calc(a, b, c, mid);
+    int next_critical = 0;
+    while (next_critical < critical.size() && critical[next_critical] <= from) {
+        next_critical++;
+    }
 
-                if (isZero(f_mid)) {
-                    answers.push_back(mid);
-                    break;
+    // Корень в узле занимает оба соседних монотонных участка, поэтому они
+    // не уточняются и один корень не попадает в ответ дважды
+    for (qint64 first = 0; first < intervals; first += grid_kernel::block_size) {
+        const int count = int(qMin<qint64>(grid_kernel::block_size, intervals - first));
+        grid_kernel::evaluate(a, b, c, from, width, first + 1, count, values + 1);
+        const quint64 sign_mask = grid_kernel::sign_changes(values, count);
+
+        for (int i = 0; i < count; i++) {
+            double left = from + double(first + i) * width;
+            const double right = from + double(first + i + 1) * width;
+            double f_left = values[i];
+            const bool right_is_root = std::abs(values[i + 1]) <= equation.rounding_error(right);
+            bool split = false;
+
+            // Критические точки внутри интервала становятся дополнительными узлами
+            while (next_critical < critical.size() && critical[next_critical] < right) {
+                const double point = critical[next_critical++];
+                if (!(point > left)) {
+                    continue; // совпадает с узлом сетки
                 }
-
-                if (f_left * f_mid < 0) {
-                    right = mid;
-                    f_right = f_mid;
-                } else {
-                    left = mid;
-                    f_left = f_mid;
+                const double f_point = equation.value(point);
+                counters.evaluations++;
+                const bool point_is_root = std::abs(f_point) <= equation.rounding_error(point);
+
+                if (point_is_root) {
+                    answers.push_back({point, polynomial::multiplicity(tangents, point, options.tolerance)});
+                } else if (!left_is_root && f_left * f_point < 0) {
+                    answers.push_back({equation.solve_bracket(left, point, f_left, f_point,
+                                                              options.refine, options.tolerance, &counters), 1});
                 }
+                left = point;
+                f_left = f_point;
+                left_is_root = point_is_root;
+                split = true;
             }
-            double root = (left + right) / 2;
-            if (isZero(Calc(a, b, c, root))) {
-                answers.push_back(root);
+
+            // Смена знака: корень гарантированно есть
+            const bool sign_change = split ? f_left * values[i + 1] < 0 : (sign_mask >> i) & 1;
+            if (sign_change && !left_is_root && !right_is_root) {
+                answers.push_back({equation.solve_bracket(left, right, f_left, values[i + 1],
+                                                          options.refine, options.tolerance, &counters), 1});
             }
-        }
-    }
 
-    // Удаление дубликатов
-    QVector<double> unique_answers;
-    for (double root : answers) {
-        bool exists = false;
-        for (double unique_root : unique_answers) {
-            if (qFuzzyCompare(root, unique_root)) {
-                exists = true;
-                break;
+            // Проверка корня в узле сетки
+            if (right_is_root) {
+                answers.push_back({right, polynomial::multiplicity(tangents, right, options.tolerance)});
             }
+            left_is_root = right_is_root;
         }
-        if (!exists) unique_answers.push_back(root);
+        values[0] = values[count];
     }
 
-    return unique_answers;
+    merge_roots(answers, options.tolerance, std::max(std::abs(from), std::abs(to)));
+    return answers;
 }
 
 /**
@@ -183,25 +311,355 @@ double functions_for_server::Calc(double a, double b, double c, double x){
     return x*x*a + x*b + c;
 }
 
+/**
+ * @brief Решает квадратное уравнение по формулам
+ * @param a Коэффициент a
+ * @param b Коэффициент b
+ * @param c Коэффициент c
+ * @return Корни по возрастанию
+ *
+ * Вместо (-b ± √D) / 2a используется пара x1 = q / a, x2 = c / q, чтобы
+ * не вычитать близкие числа при |b| ≫ |4ac|. Дискриминант, отличающийся
+ * от нуля на величину ошибки округления, считается нулевым
+ */
+QVector<polynomial::root> functions_for_server::analytic_quadratic(double a, double b, double c) {
+    QVector<polynomial::root> roots;
+
+    if (qFuzzyIsNull(a)) {
+        if (!qFuzzyIsNull(b)) {
+            roots.push_back({-c / b + 0.0, 1});
+        }
+        return roots;
+    }
+
+    const double discriminant = b * b - 4 * a * c;
+    const double rounding = 4 * std::numeric_limits<double>::epsilon()
+                            * std::max(b * b, std::abs(4 * a * c));
+
+    if (std::abs(discriminant) <= rounding) {
+        roots.push_back({-b / (2 * a) + 0.0, 2});
+        return roots;
+    }
+    if (discriminant < 0) {
+        return roots;
+    }
+
+    const double q = -0.5 * (b + std::copysign(std::sqrt(discriminant), b));
+    double x1 = q / a + 0.0;
+    double x2 = c / q + 0.0;
+    if (x1 > x2) {
+        std::swap(x1, x2);
+    }
+    roots.push_back({x1, 1});
+    roots.push_back({x2, 1});
+    return roots;
+}
+
+/**
+ * @brief Устанавливает режим решателя по умолчанию
+ * @param mode Режим решателя
+ */
+void functions_for_server::set_default_mode(solver_mode mode) {
+    default_mode = mode;
+}
+
+/**
+ * @brief Разбирает параметры решения из сообщения клиента
+ * @param options Строка вида "ключ=значение$ключ=значение"
+ * @return Параметры решения
+ *
+ * Неизвестные ключи и значения игнорируются
+ */
+solver_options functions_for_server::parse_options(const QString& options) const {
+    solver_options result;
+    result.mode = default_mode;
+    bool refine_given = false;
+
+    for (const QString& option : options.split("$", Qt::SkipEmptyParts)) {
+        QString key = option.section("=", 0, 0).trimmed();
+        QString value = option.section("=", 1).trimmed();
+        if (key == "mode") {
+            if (value == "analytic")
+                result.mode = solver_mode::ANALYTIC;
+            else if (value == "bisection")
+                result.mode = solver_mode::BISECTION;
+        } else if (key == "refine") {
+            refine_given = true;
+            if (value == "bisection")
+                result.refine = polynomial::refinement::BISECTION;
+            else if (value == "illinois")
+                result.refine = polynomial::refinement::ILLINOIS;
+            else if (value == "brent")
+                result.refine = polynomial::refinement::BRENT;
+            else if (value == "newton")
+                result.refine = polynomial::refinement::NEWTON;
+            else
+                refine_given = false;
+        } else if (key == "tol") {
+            bool ok;
+            double tolerance = value.toDouble(&ok);
+            if (ok && tolerance > 0) {
+                result.tolerance = qBound(min_tolerance, tolerance, max_tolerance);
+            }
+        } else if (key == "stats") {
+            result.stats = value == "1" || value == "true";
+        }
+    }
+
+    // В учебном режиме корни по умолчанию уточняются бисекцией
+    if (!refine_given && result.mode == solver_mode::BISECTION) {
+        result.refine = polynomial::refinement::BISECTION;
+    }
+    return result;
+}
+
+/**
+ * @brief Формирует ответ клиенту
+ * @param roots Найденные корни
+ * @param options Параметры решения
+ * @param stats Затраты на решение
+ * @return Строка ответа
+ *
+ * Поле затрат добавляется последним, поэтому клиенты, читающие
+ * только второе поле, его не замечают
+ */
+QString functions_for_server::format_answer(const QVector<polynomial::root>& roots, const solver_options& options,
+                                            const polynomial::statistics& stats) {
+    QString solution = QString("answer|");
+    if (roots.isEmpty()) {
+        solution.append("Решений нет");
+    } else {
+        bool multiple = false;
+        for (const auto &el : roots) {
+            solution.append(QString::number(el.value));
+            solution.append("$");
+            multiple = multiple || el.multiplicity > 1;
+        }
+        solution.chop(1);
+
+        if (multiple) {
+            solution.append("|multiplicity=");
+            for (const auto &el : roots) {
+                solution.append(QString::number(el.multiplicity));
+                solution.append("$");
+            }
+            solution.chop(1);
+        }
+    }
+
+    if (options.stats) {
+        solution.append(QString("|iterations=%1$evaluations=%2").arg(stats.iterations).arg(stats.evaluations));
+    }
+    return solution;
+}
+
+/**
+ * @brief Строит ключ кэша для уравнения
+ * @param kind Вид уравнения
+ * @param coefficients Коэффициенты
+ * @param options Параметры решения
+ * @return Ключ кэша
+ */
+QByteArray functions_for_server::cache_key(char kind, const QVector<double>& coefficients, const QString& options) const {
+    if (coefficients.isEmpty()) {
+        return QByteArray();
+    }
+    double scale = 0;
+    for (double value : coefficients) {
+        if (!std::isfinite(value)) {
+            return QByteArray();
+        }
+        scale = std::max(scale, std::abs(value));
+    }
+
+    // Нормировка допустима, только если решатель примет те же решения о нулевых коэффициентах
+    double factor = 1;
+    for (double value : coefficients) {
+        if (value != 0) {
+            factor = value < 0 ? -scale : scale;
+            break;
+        }
+    }
+    for (double value : coefficients) {
+        if (qFuzzyIsNull(value) != qFuzzyIsNull(value / factor)) {
+            factor = 1;
+            break;
+        }
+    }
+
+    const solver_options parsed = parse_options(options);
+    QByteArray key;
+    key.reserve(8 + int(sizeof(double)) * (coefficients.size() + 1));
+    key.append(kind);
+    key.append(char(parsed.mode));
+    key.append(char(parsed.refine));
+    key.append(char(parsed.stats));
+    key.append(factor == 1 ? 'r' : 'n');
+    key.append(reinterpret_cast<const char*>(&parsed.tolerance), sizeof(double));
+    for (double value : coefficients) {
+        double normalized = value / factor + 0.0;
+        key.append(reinterpret_cast<const char*>(&normalized), sizeof(double));
+    }
+    return key;
+}
+
+/**
+ * @brief Отвечает из кэша или ставит решение в пул потоков
+ * @param context Контекст запроса
+ * @param key Ключ кэша
+ * @param solve Функция, формирующая ответ
+ */
+void functions_for_server::dispatch_solution(const request_context& context, const QByteArray& key,
+                                             std::function<QString()> solve)
+{
+    const bool cacheable = cache != nullptr && !key.isEmpty();
+    QByteArray cached;
+    if (cacheable && cache->find(key, cached)) {
+        connection_registry::reply(context, cached);
+        return;
+    }
+
+    // Одинаковые запросы, пришедшие во время решения, ждут его результата
+    if (!key.isEmpty()) {
+        QMutexLocker locker(&flight_mutex);
+        auto found = in_flight.find(key);
+        if (found != in_flight.end()) {
+            found.value().push_back(context);
+            coalesced.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        // Решение могло завершиться между первым поиском в кэше и захватом
+        // мьютекса: тогда ответ уже в кэше, а записи о решении нет
+        if (cacheable && cache->find(key, cached)) {
+            locker.unlock();
+            connection_registry::reply(context, cached);
+            return;
+        }
+        in_flight.insert(key, QVector<request_context>());
+    }
+
+    compute_pool::job task = [this, context, key, cacheable, solve]() {
+        QByteArray answer = solve().toUtf8();
+        if (cacheable) {
+            cache->insert(key, answer);
+        }
+
+        // Ответ помещается в кэш раньше, чем уравнение снимается с решения, а
+        // запрос, не нашедший записи о решении, повторно ищет ответ в кэше под
+        // flight_mutex, поэтому он либо найдёт ответ, либо присоединится
+        QVector<request_context> waiting;
+        if (!key.isEmpty()) {
+            QMutexLocker locker(&flight_mutex);
+            waiting = in_flight.take(key);
+        }
+
+        connection_registry::reply(context, answer);
+        for (const request_context& waiter : waiting) {
+            connection_registry::reply(waiter, answer);
+        }
+    };
+
+    if (solver_pool == nullptr) {
+        task();
+        return;
+    }
+    solver_pool->submit(std::move(task));
+}
+
 /// @name Обработчики уравнений
 /// @{
 /**
- * @brief Решает линейное уравнение
- * @param a Коэффициент a (в строковом формате)
- * @param b Коэффициент b (в строковом формате)
+ * @brief Решает линейное уравнение через кэш и пул потоков
+ * @param context Контекст запроса
+ * @param coefficients Коэффициенты a, b
+ * @param options Параметры решения
  */
-void functions_for_server::slot_linear_equation(QString a, QString b)
+void functions_for_server::slot_linear_equation(request_context context, QVector<double> coefficients, QString options)
 {
-    bool ok1, ok2;
-    double coeff_a = a.toDouble(&ok1);
-    double coeff_b = b.toDouble(&ok2);
-    QString solution;
+    if (coefficients.size() != 2) {
+        connection_registry::reply(context, QString("answer|Некорректный ввод!").toUtf8());
+        return;
+    }
+    dispatch_solution(context, cache_key('l', coefficients, options), [this, coefficients, options]() {
+        return solve_linear(coefficients[0], coefficients[1], options);
+    });
+}
+
+/**
+ * @brief Решает квадратное уравнение через кэш и пул потоков
+ * @param context Контекст запроса
+ * @param coefficients Коэффициенты a, b, c
+ * @param options Параметры решения
+ */
+void functions_for_server::slot_quadratic_equation(request_context context, QVector<double> coefficients,
+                                                   QString options)
+{
+    if (coefficients.size() != 3) {
+        connection_registry::reply(context, QString("answer|Некорректный ввод").toUtf8());
+        return;
+    }
+    dispatch_solution(context, cache_key('q', coefficients, options), [this, coefficients, options]() {
+        return solve_quadratic(coefficients[0], coefficients[1], coefficients[2], options);
+    });
+}
+
+/**
+ * @brief Решает уравнение с многочленом через кэш и пул потоков
+ * @param context Контекст запроса
+ * @param coefficients Коэффициенты, начиная со старшей степени
+ * @param options Параметры решения
+ */
+void functions_for_server::slot_polynomial_equation(request_context context, QVector<double> coefficients,
+                                                    QString options)
+{
+    if (coefficients.isEmpty()) {
+        connection_registry::reply(context, QString("answer|Некорректный ввод").toUtf8());
+        return;
+    }
+    dispatch_solution(context, cache_key('p', coefficients, options), [this, coefficients, options]() {
+        return solve_polynomial(coefficients, options);
+    });
+}
+
+/**
+ * @brief Решает пакет квадратных уравнений в пуле потоков
+ * @param context Контекст запроса
+ * @param payload Двоичная нагрузка пакета
+ *
+ * Пакеты не кэшируются: ответ на пакет велик и почти никогда не повторяется
+ */
+void functions_for_server::slot_batch_equation(request_context context, QByteArray payload)
+{
+    compute_pool::job task = [context, payload]() {
+        quadratic_batch batch;
+        if (!batch.unpack(payload)) {
+            connection_registry::reply(context, QString("answer|Некорректный ввод").toUtf8());
+            return;
+        }
+        batch.solve();
+        connection_registry::reply(context, batch.pack());
+    };
 
-    if (!ok1 || !ok2) {
-        solution = "answer|Некорректный ввод!";
-        emit this->signal_equation_solution(solution);
+    if (solver_pool == nullptr) {
+        task();
         return;
     }
+    solver_pool->submit(std::move(task));
+}
+
+/**
+ * @brief Решает линейное уравнение
+ * @param coeff_a Коэффициент a
+ * @param coeff_b Коэффициент b
+ * @param options Параметры решения
+ * @return Ответ клиенту
+ *
+ * В режиме ANALYTIC корень вычисляется как -b/a, в режиме BISECTION
+ * ищется методом половинного деления
+ */
+QString functions_for_server::solve_linear(double coeff_a, double coeff_b, const QString& options)
+{
+    QString solution;
 
     if (qFuzzyIsNull(coeff_a)) {
         if (qFuzzyIsNull(coeff_b)) {
@@ -210,72 +668,74 @@ void functions_for_server::slot_linear_equation(QString a, QString b)
             solution = "answer|Решений нет";
         }
     } else {
-        double vertex = -coeff_b/(2*coeff_a);
-        QVector<QPair<double, double>> ans = diaposons(vertex-5, vertex+5, 0.01);
-        QVector<double> korni = find_x(ans, 0, coeff_a, coeff_b);
-
-        if (korni.size() > 0) {
-            solution = QString("answer|");
-            for (const auto &el : korni) {
-                solution.append(QString::number(el));
-                solution.append("$");
-            }
-            solution.chop(1);
-            double answer = -coeff_b / coeff_a;
-            solution = QString("answer|%1").arg(answer);
-        }
-        else {
-            solution = QString("answer|Решений нет");
+        const solver_options parsed = parse_options(options);
+        polynomial::statistics stats;
+        if (parsed.mode == solver_mode::BISECTION) {
+            const double step = 0.01;
+            double bound = root_bound({coeff_a, coeff_b}) + step;
+            solution = format_answer(find_x(-bound, bound, step, 0, coeff_a, coeff_b, parsed, &stats),
+                                     parsed, stats);
+        } else {
+            solution = format_answer(analytic_quadratic(0, coeff_a, coeff_b), parsed, stats);
         }
     }
 
-    emit this->signal_equation_solution(solution);
+    return solution;
 }
 
 /**
  * @brief Решает квадратное уравнение
- * @param a Коэффициент a (в строковом формате)
- * @param b Коэффициент b (в строковом формате)
- * @param c Коэффициент c (в строковом формате)
+ * @param coeff_a Коэффициент a
+ * @param coeff_b Коэффициент b
+ * @param coeff_c Коэффициент c
+ * @param options Параметры решения
+ * @return Ответ клиенту
  */
-void functions_for_server::slot_quadratic_equation(QString a, QString b, QString c)
+QString functions_for_server::solve_quadratic(double coeff_a, double coeff_b, double coeff_c,
+                                              const QString& options)
 {
-    bool ok1, ok2, ok3;
-    double coeff_a = a.toDouble(&ok1);
-    double coeff_b = b.toDouble(&ok2);
-    double coeff_c = c.toDouble(&ok3);
-    QString solution;
-
-    if (!ok1 || !ok2 || !ok3) {
-        solution = "answer|Некорректный ввод";
-        emit this->signal_equation_solution(solution);
-        return;
-    }
-
     if (qFuzzyIsNull(coeff_a) && qFuzzyIsNull(coeff_b)) {
         if (qFuzzyIsNull(coeff_c)) {
-            emit this->signal_equation_solution("answer|Бесконечное число решений");
-            return;
+            return "answer|Бесконечное число решений";
         }
-        emit this->signal_equation_solution("answer|Решений нет");
-        return;
+        return "answer|Решений нет";
     }
 
-    QVector<QPair<double, double>> ans = diaposons(-10, 10, 0.001);
-    QVector<double> korni = find_x(ans, coeff_a, coeff_b, coeff_c);
+    const solver_options parsed = parse_options(options);
+    polynomial::statistics stats;
+    QVector<polynomial::root> korni;
+    if (parsed.mode == solver_mode::BISECTION) {
+        const double step = 0.001;
+        double bound = root_bound({coeff_a, coeff_b, coeff_c}) + step;
+        korni = find_x(-bound, bound, step, coeff_a, coeff_b, coeff_c, parsed, &stats);
+    } else {
+        korni = analytic_quadratic(coeff_a, coeff_b, coeff_c);
+    }
+    return format_answer(korni, parsed, stats);
+}
 
-    if (korni.size() > 0) {
-        solution = QString("answer|");
-        for (const auto &el : korni) {
-            solution.append(QString::number(el));
-            solution.append("$");
-        }
-        solution.chop(1);
+/**
+ * @brief Решает уравнение с многочленом произвольной степени
+ * @param coefficients Коэффициенты, начиная со старшей степени
+ * @param options Параметры решения
+ * @return Ответ клиенту
+ *
+ * Корни отделяются последовательностью Штурма и уточняются методом
+ * из параметра refine (по умолчанию Ньютона, а в режиме BISECTION - бисекцией)
+ */
+QString functions_for_server::solve_polynomial(const QVector<double>& coefficients, const QString& options)
+{
+    polynomial equation(coefficients);
+    if (equation.degree() > max_polynomial_degree) {
+        return "answer|Некорректный ввод";
     }
-    else {
-        solution = QString("answer|Решений нет");
+    if (equation.degree() < 0) {
+        return "answer|Бесконечное число решений";
     }
 
-    emit this->signal_equation_solution(solution);
+    const solver_options parsed = parse_options(options);
+    polynomial::statistics stats;
+    QVector<polynomial::root> roots = equation.roots(parsed.refine, parsed.tolerance, &stats);
+    return format_answer(roots, parsed, stats);
 }
 /// @}
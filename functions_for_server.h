@@ -5,6 +5,38 @@
 #include <ctime>
 #include <QObject>
 #include <QList>
+#include <QStringList>
+#include <QHash>
+#include <QMutex>
+#include <atomic>
+#include "request_context.h"
+#include "compute_pool.h"
+#include "polynomial.h"
+#include "result_cache.h"
+
+/**
+ * @brief Режим работы решателя уравнений
+ */
+enum class solver_mode {
+    ANALYTIC,  ///< Решение по формулам (по умолчанию)
+    BISECTION, ///< Поиск корней методом половинного деления на сетке (учебный режим)
+};
+
+/**
+ * @brief Параметры решения, переданные клиентом вместе с уравнением
+ *
+ * Передаются необязательным последним полем сообщения в виде
+ * "ключ=значение$ключ=значение", например
+ * "equation|quadratic|1$-5$6|mode=bisection$refine=brent$tol=1e-10$stats=1".
+ * Ключи: mode (analytic, bisection), refine (bisection, illinois, brent, newton),
+ * tol (относительная точность корня), stats (1 - добавить затраты к ответу)
+ */
+struct solver_options {
+    solver_mode mode = solver_mode::ANALYTIC; ///< Режим решателя
+    polynomial::refinement refine = polynomial::refinement::NEWTON; ///< Способ уточнения корня
+    double tolerance = 1e-12; ///< Относительная точность корня
+    bool stats = false;       ///< Добавлять ли к ответу число итераций и вычислений
+};
 
 /**
  * @brief Класс вспомогательных функций для сервера
@@ -21,6 +53,85 @@ private:
     functions_for_server(); ///< Приватный конструктор (реализация Singleton)
     functions_for_server(const functions_for_server&); ///< Запрещенный конструктор копирования
     static functions_for_server* p_instance; ///< Указатель на единственный экземпляр класса
+    compute_pool* solver_pool = nullptr; ///< Пул потоков для решения уравнений
+    result_cache* cache = nullptr; ///< Кэш готовых ответов (nullptr - кэш выключен)
+    QMutex flight_mutex; ///< Защита списка решаемых уравнений
+    QHash<QByteArray, QVector<request_context>> in_flight; ///< Решаемые уравнения и ожидающие их запросы
+    std::atomic<quint64> coalesced{0}; ///< Запросы, присоединённые к уже идущему решению
+    solver_mode default_mode = solver_mode::ANALYTIC; ///< Режим решателя, если клиент его не указал
+
+    /**
+     * @brief Разбор параметров решения
+     * @param options Строка параметров из сообщения клиента
+     * @return Параметры; неуказанные значения берутся по умолчанию
+     */
+    solver_options parse_options(const QString& options) const;
+
+    /**
+     * @brief Формирование ответа клиенту по найденным корням
+     * @param roots Корни уравнения с кратностью
+     * @param options Параметры решения
+     * @param stats Затраты на решение
+     * @return Строка ответа "answer|x1$x2" или "answer|Решений нет";
+     * если среди корней есть кратные, добавляется поле "|multiplicity=k1$k2",
+     * при options.stats - поле "|iterations=N$evaluations=M"
+     */
+    static QString format_answer(const QVector<polynomial::root>& roots, const solver_options& options,
+                                 const polynomial::statistics& stats);
+
+    /**
+     * @brief Ключ кэша для уравнения
+     * @param kind Вид уравнения ('l' - линейное, 'q' - квадратное, 'p' - многочлен)
+     * @param coefficients Коэффициенты
+     * @param options Параметры решения
+     * @return Ключ или пустой массив, если коэффициенты некорректны
+     *
+     * Коэффициенты делятся на наибольший по модулю и приводятся к положительному
+     * старшему, поэтому 2x² - 10x + 12 и x² - 5x + 6 дают один ключ. Если при этом
+     * меняется результат проверки qFuzzyIsNull какого-либо коэффициента,
+     * ключ строится по исходным коэффициентам. В ключ входят также mode, refine,
+     * tol и stats, поскольку от них зависит текст ответа
+     */
+    QByteArray cache_key(char kind, const QVector<double>& coefficients, const QString& options) const;
+
+    /**
+     * @brief Ответ из кэша или постановка решения в пул потоков
+     * @param context Контекст запроса
+     * @param key Ключ кэша (пустой - не кэшировать)
+     * @param solve Функция, формирующая ответ
+     *
+     * При попадании в кэш ответ отправляется из вызывающего потока соединения,
+     * пул решателя при этом не используется. Если такое же уравнение уже
+     * решается, запрос присоединяется к нему и получает тот же ответ
+     */
+    void dispatch_solution(const request_context& context, const QByteArray& key, std::function<QString()> solve);
+
+    /**
+     * @brief Решение линейного уравнения
+     * @param a Коэффициент a
+     * @param b Коэффициент b
+     * @param options Параметры решения
+     * @return Ответ клиенту
+     */
+    QString solve_linear(double a, double b, const QString& options);
+
+    /**
+     * @brief Решение квадратного уравнения
+     * @param a Коэффициент a
+     * @param b Коэффициент b
+     * @param c Коэффициент c
+     * @param options Параметры решения
+     * @return Ответ клиенту
+     */
+    QString solve_quadratic(double a, double b, double c, const QString& options);
+
+    /**
+     * @brief Решение уравнения с многочленом произвольной степени
+     * @param coefficients Коэффициенты, начиная со старшей степени
+     * @param options Параметры решения
+     * @return Ответ клиенту
+     */
+    QString solve_polynomial(const QVector<double>& coefficients, const QString& options);
 
 public:
     /**
@@ -29,6 +140,58 @@ public:
      */
     static functions_for_server* get_instance();
 
+    /**
+     * @brief Деструктор
+     *
+     * Останавливает пул потоков решателя
+     */
+    ~functions_for_server();
+
+    /**
+     * @brief Запуск пула потоков решателя
+     * @param threads Количество потоков (0 - по числу ядер процессора)
+     *
+     * До запуска пула уравнения решаются в потоке вызывающего соединения
+     */
+    void start_solver_pool(int threads = 0);
+
+    /**
+     * @brief Включение кэша готовых ответов
+     * @param budget Бюджет памяти кэша в байтах (0 - кэш выключен)
+     */
+    void start_result_cache(qint64 budget);
+
+    /**
+     * @brief Счётчики кэша готовых ответов
+     * @return Снимок счётчиков (нулевые, если кэш выключен)
+     */
+    result_cache::counters cache_statistics() const;
+
+    /**
+     * @brief Количество запросов, присоединённых к уже идущему решению
+     * @return Значение счётчика
+     */
+    quint64 coalesced_requests() const;
+
+    /**
+     * @brief Установка режима решателя по умолчанию
+     * @param mode Режим, используемый для запросов без параметра mode
+     */
+    void set_default_mode(solver_mode mode);
+
+    /**
+     * @brief Решение квадратного уравнения по формулам
+     * @param a Коэффициент a
+     * @param b Коэффициент b
+     * @param c Коэффициент c
+     * @return Действительные корни по возрастанию (двойной корень при D = 0)
+     *
+     * Использует устойчивую к потере точности форму формулы корней:
+     * q = -(b + sign(b)·√D) / 2, x1 = q / a, x2 = c / q.
+     * При a = 0 решает линейное уравнение bx + c = 0
+     */
+    static QVector<polynomial::root> analytic_quadratic(double a, double b, double c);
+
     /**
      * @brief Получение текущего времени сервера
      * @return Строка с текущим временем сервера
@@ -43,23 +206,34 @@ public:
     void send_email_to_client(QString email, QString code);
 
     /**
-     * @brief Генерация диапазонов значений
-     * @param a Начальное значение
-     * @param b Конечное значение
-     * @param step Шаг
-     * @return Вектор пар, представляющих диапазоны
-     */
-    QVector<QPair<double, double>> diaposons(double a, double b, double step);
-
-    /**
-     * @brief Поиск значений x в заданных диапазонах
-     * @param diapozon Вектор диапазонов для поиска
+     * @brief Поиск значений x на адаптивной сетке
+     * @param from Начало отрезка поиска
+     * @param to Конец отрезка поиска
+     * @param step Наименьший шаг сетки
      * @param a Коэффициент a уравнения
      * @param b Коэффициент b уравнения
      * @param c Коэффициент c уравнения
-     * @return Вектор найденных значений x
+     * @param options Параметры решения (способ уточнения и точность)
+     * @param stats Счётчики затрат (может быть nullptr)
+     * @return Вектор найденных значений x с кратностью
+     *
+     * Отрезок проходится сеткой, в узлы которой добавлены критические точки
+     * уравнения. Между соседними узлами уравнение монотонно, поэтому каждый
+     * простой корень отмечается сменой знака и уточняется методом options.refine,
+     * а корни касания находятся в критических точках при любом шаге сетки
      */
-    QVector<double> find_x(const QVector<QPair<double, double>>& diapozon, double a, double b, double c);
+    QVector<polynomial::root> find_x(double from, double to, double step, double a, double b, double c,
+                           const solver_options& options = solver_options(),
+                           polynomial::statistics* stats = nullptr);
+
+    /**
+     * @brief Граница модулей корней многочлена
+     * @param coefficients Коэффициенты, начиная со старшей степени
+     * @return Число R, такое что все корни лежат в [-R, R]
+     *
+     * См. polynomial::root_bound
+     */
+    static double root_bound(const QVector<double>& coefficients);
 
     /**
      * @brief Вычисление значения уравнения
@@ -71,33 +245,43 @@ public:
      */
     double Calc(double a, double b, double c, double x);
 
-signals:
-    /// @name Сигналы главного клиентского окна
-    /// @{
-    /**
-     * @brief Сигнал с решением уравнения
-     * @param Решение уравнения в строковом формате
-     */
-    void signal_equation_solution(QString);
-    /// @}
-
 public slots:
     /// @name Слоты для работы с уравнениями
+    /// Вызываются напрямую из потока соединения и только ставят задачу в пул
     /// @{
     /**
      * @brief Решение линейного уравнения
-     * @param a Коэффициент a (в строковом формате)
-     * @param b Коэффициент b (в строковом формате)
+     * @param context Контекст запроса, по которому доставляется ответ
+     * @param coefficients Коэффициенты a, b (пустой вектор - некорректный ввод)
+     * @param options Параметры решения (может быть пустой)
      */
-    void slot_linear_equation(QString a, QString b);
+    void slot_linear_equation(request_context context, QVector<double> coefficients, QString options);
 
     /**
      * @brief Решение квадратного уравнения
-     * @param a Коэффициент a (в строковом формате)
-     * @param b Коэффициент b (в строковом формате)
-     * @param c Коэффициент c (в строковом формате)
+     * @param context Контекст запроса, по которому доставляется ответ
+     * @param coefficients Коэффициенты a, b, c (пустой вектор - некорректный ввод)
+     * @param options Параметры решения (может быть пустой)
+     */
+    void slot_quadratic_equation(request_context context, QVector<double> coefficients, QString options);
+
+    /**
+     * @brief Решение уравнения с многочленом произвольной степени
+     * @param context Контекст запроса, по которому доставляется ответ
+     * @param coefficients Коэффициенты, начиная со старшей степени (пустой вектор - некорректный ввод)
+     * @param options Параметры решения (может быть пустой)
+     */
+    void slot_polynomial_equation(request_context context, QVector<double> coefficients, QString options);
+
+    /**
+     * @brief Решение пакета квадратных уравнений
+     * @param context Контекст запроса, по которому доставляется ответ
+     * @param payload Двоичная нагрузка пакета (см. quadratic_batch)
+     *
+     * Ответ - одно сообщение "answer|batch|" с результатами всех уравнений
+     * или "answer|Некорректный ввод", если размер нагрузки не совпадает с числом уравнений
      */
-    void slot_quadratic_equation(QString a, QString b, QString c);
+    void slot_batch_equation(request_context context, QByteArray payload);
     /// @}
 };
 
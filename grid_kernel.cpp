@@ -0,0 +1,262 @@
+#include "../include/grid_kernel.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QString>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GRID_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+/// Ядро вычисления значений
+using evaluate_function = void (*)(double, double, double, double, double, qint64, int, double*);
+/// Ядро построения маски
+using sign_changes_function = quint64 (*)(const double*, int);
+
+/**
+ * @brief Реализация ядра для одного набора инструкций
+ */
+struct kernel_functions {
+    evaluate_function evaluate;        ///< Вычисление значений
+    sign_changes_function sign_changes; ///< Построение маски
+};
+
+/**
+ * @brief Скалярное вычисление трёхчлена в узлах сетки
+ */
+static void evaluate_scalar(double a, double b, double c, double from, double width,
+                            qint64 first, int count, double* values) {
+    for (int i = 0; i < count; i++) {
+        double x = from + double(first + i) * width;
+        values[i] = (a * x + b) * x + c;
+    }
+}
+
+/**
+ * @brief Скалярное построение маски смены знака
+ */
+static quint64 sign_changes_scalar(const double* values, int count) {
+    quint64 mask = 0;
+    for (int i = 0; i < count; i++) {
+        if (values[i] * values[i + 1] < 0) {
+            mask |= quint64(1) << i;
+        }
+    }
+    return mask;
+}
+
+#ifdef GRID_KERNEL_X86
+/**
+ * @brief Вычисление трёхчлена в узлах сетки, 2 узла за инструкцию
+ */
+__attribute__((target("sse2")))
+static void evaluate_sse2(double a, double b, double c, double from, double width,
+                          qint64 first, int count, double* values) {
+    const __m128d va = _mm_set1_pd(a);
+    const __m128d vb = _mm_set1_pd(b);
+    const __m128d vc = _mm_set1_pd(c);
+    const __m128d vfrom = _mm_set1_pd(from);
+    const __m128d vwidth = _mm_set1_pd(width);
+    const __m128d two = _mm_set1_pd(2);
+    __m128d index = _mm_setr_pd(double(first), double(first + 1));
+
+    int i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128d x = _mm_add_pd(vfrom, _mm_mul_pd(index, vwidth));
+        __m128d y = _mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(va, x), vb), x), vc);
+        _mm_storeu_pd(values + i, y);
+        index = _mm_add_pd(index, two);
+    }
+    evaluate_scalar(a, b, c, from, width, first + i, count - i, values + i);
+}
+
+/**
+ * @brief Построение маски смены знака, 2 интервала за инструкцию
+ */
+__attribute__((target("sse2")))
+static quint64 sign_changes_sse2(const double* values, int count) {
+    const __m128d zero = _mm_setzero_pd();
+    quint64 mask = 0;
+
+    int i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128d product = _mm_mul_pd(_mm_loadu_pd(values + i), _mm_loadu_pd(values + i + 1));
+        mask |= quint64(_mm_movemask_pd(_mm_cmplt_pd(product, zero))) << i;
+    }
+    if (i < count) {
+        mask |= sign_changes_scalar(values + i, count - i) << i;
+    }
+    return mask;
+}
+
+/**
+ * @brief Вычисление трёхчлена в узлах сетки, 4 узла за инструкцию
+ */
+__attribute__((target("avx2")))
+static void evaluate_avx2(double a, double b, double c, double from, double width,
+                          qint64 first, int count, double* values) {
+    const __m256d va = _mm256_set1_pd(a);
+    const __m256d vb = _mm256_set1_pd(b);
+    const __m256d vc = _mm256_set1_pd(c);
+    const __m256d vfrom = _mm256_set1_pd(from);
+    const __m256d vwidth = _mm256_set1_pd(width);
+    const __m256d four = _mm256_set1_pd(4);
+    __m256d index = _mm256_setr_pd(double(first), double(first + 1), double(first + 2), double(first + 3));
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d x = _mm256_add_pd(vfrom, _mm256_mul_pd(index, vwidth));
+        __m256d y = _mm256_add_pd(_mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(va, x), vb), x), vc);
+        _mm256_storeu_pd(values + i, y);
+        index = _mm256_add_pd(index, four);
+    }
+    evaluate_scalar(a, b, c, from, width, first + i, count - i, values + i);
+}
+
+/**
+ * @brief Построение маски смены знака, 4 интервала за инструкцию
+ */
+__attribute__((target("avx2")))
+static quint64 sign_changes_avx2(const double* values, int count) {
+    const __m256d zero = _mm256_setzero_pd();
+    quint64 mask = 0;
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d product = _mm256_mul_pd(_mm256_loadu_pd(values + i), _mm256_loadu_pd(values + i + 1));
+        mask |= quint64(_mm256_movemask_pd(_mm256_cmp_pd(product, zero, _CMP_LT_OQ))) << i;
+    }
+    if (i < count) {
+        mask |= sign_changes_scalar(values + i, count - i) << i;
+    }
+    return mask;
+}
+#endif
+
+/**
+ * @brief Проверяет, поддерживает ли процессор набор инструкций
+ * @param set Набор инструкций
+ * @return true если набор доступен
+ */
+static bool is_supported(grid_kernel::instruction_set set) {
+    switch (set) {
+    case grid_kernel::instruction_set::SCALAR:
+        return true;
+#ifdef GRID_KERNEL_X86
+    case grid_kernel::instruction_set::SSE2:
+        return __builtin_cpu_supports("sse2");
+    case grid_kernel::instruction_set::AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Возвращает реализацию ядра для набора инструкций
+ * @param set Набор инструкций
+ * @return Функции ядра
+ */
+static kernel_functions functions_for(grid_kernel::instruction_set set) {
+    switch (set) {
+#ifdef GRID_KERNEL_X86
+    case grid_kernel::instruction_set::AVX2:
+        return {evaluate_avx2, sign_changes_avx2};
+    case grid_kernel::instruction_set::SSE2:
+        return {evaluate_sse2, sign_changes_sse2};
+#endif
+    default:
+        return {evaluate_scalar, sign_changes_scalar};
+    }
+}
+
+/**
+ * @brief Возвращает название набора инструкций
+ * @param set Набор инструкций
+ * @return Название для журнала
+ */
+static QString name_of(grid_kernel::instruction_set set) {
+    switch (set) {
+    case grid_kernel::instruction_set::AVX2:
+        return "AVX2";
+    case grid_kernel::instruction_set::SSE2:
+        return "SSE2";
+    default:
+        return "scalar";
+    }
+}
+
+/**
+ * @brief Выбирает наилучший доступный набор инструкций
+ * @return Набор инструкций
+ */
+grid_kernel::instruction_set grid_kernel::selected() {
+    static const instruction_set best = is_supported(instruction_set::AVX2) ? instruction_set::AVX2
+                                        : is_supported(instruction_set::SSE2) ? instruction_set::SSE2
+                                                                              : instruction_set::SCALAR;
+    return best;
+}
+
+/**
+ * @brief Вычисляет трёхчлен в узлах сетки
+ * @param a Коэффициент a
+ * @param b Коэффициент b
+ * @param c Коэффициент c
+ * @param from Начало сетки
+ * @param width Шаг сетки
+ * @param first Номер первого узла
+ * @param count Количество узлов
+ * @param values Массив значений
+ */
+void grid_kernel::evaluate(double a, double b, double c, double from, double width,
+                           qint64 first, int count, double* values) {
+    static const kernel_functions kernel = functions_for(selected());
+    kernel.evaluate(a, b, c, from, width, first, count, values);
+}
+
+/**
+ * @brief Строит маску интервалов со сменой знака
+ * @param values Значения в count + 1 узлах
+ * @param count Количество интервалов
+ * @return Битовая маска
+ */
+quint64 grid_kernel::sign_changes(const double* values, int count) {
+    static const kernel_functions kernel = functions_for(selected());
+    return kernel.sign_changes(values, count);
+}
+
+/**
+ * @brief Микротест производительности ядра
+ *
+ * Для каждого доступного набора инструкций вычисляет трёхчлен
+ * в 2^24 узлах и строит маски смены знака
+ */
+void grid_kernel::benchmark() {
+    const qint64 points = qint64(1) << 24;
+    const instruction_set sets[] = {instruction_set::SCALAR, instruction_set::SSE2, instruction_set::AVX2};
+    double values[block_size + 1];
+
+    for (instruction_set set : sets) {
+        if (!is_supported(set)) {
+            continue;
+        }
+        kernel_functions kernel = functions_for(set);
+
+        QElapsedTimer timer;
+        timer.start();
+        quint64 flagged = 0;
+        values[0] = 0;
+        for (qint64 first = 1; first < points; first += block_size) {
+            kernel.evaluate(1, -0.5, -3.1, -1000, 1e-4, first, block_size, values + 1);
+            flagged += quint64(qPopulationCount(kernel.sign_changes(values, block_size)));
+            values[0] = values[block_size];
+        }
+        double seconds = qMax<qint64>(1, timer.nsecsElapsed()) / 1e9;
+
+        qDebug() << QString("grid_kernel %1: %2 млн вычислений/с (смен знака: %3)")
+                        .arg(name_of(set))
+                        .arg(double(points) / seconds / 1e6, 0, 'f', 1)
+                        .arg(flagged);
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef GRID_KERNEL_H
+#define GRID_KERNEL_H
+
+#include <QtGlobal>
+
+/**
+ * @brief Векторизованное вычисление квадратного трёхчлена на сетке
+ *
+ * Вычисляет ax² + bx + c в узлах x_i = from + i·width по 4 (AVX2)
+ * или 2 (SSE2) узла за инструкцию и строит битовую маску интервалов
+ * со сменой знака. Набор инструкций выбирается при первом обращении
+ * по возможностям процессора; при их отсутствии используется скалярный код
+ */
+class grid_kernel
+{
+public:
+    /**
+     * @brief Набор инструкций ядра
+     */
+    enum class instruction_set {
+        SCALAR, ///< Без векторных инструкций
+        SSE2,   ///< 2 узла за инструкцию
+        AVX2,   ///< 4 узла за инструкцию
+    };
+
+    static const int block_size = 64; ///< Наибольшее число интервалов в одной маске
+
+    /**
+     * @brief Набор инструкций, выбранный для текущего процессора
+     * @return Набор инструкций
+     */
+    static instruction_set selected();
+
+    /**
+     * @brief Вычисление трёхчлена в узлах сетки
+     * @param a Коэффициент a
+     * @param b Коэффициент b
+     * @param c Коэффициент c
+     * @param from Начало сетки
+     * @param width Шаг сетки
+     * @param first Номер первого узла
+     * @param count Количество узлов
+     * @param values Массив для count значений
+     */
+    static void evaluate(double a, double b, double c, double from, double width,
+                         qint64 first, int count, double* values);
+
+    /**
+     * @brief Маска интервалов со сменой знака
+     * @param values Значения в count + 1 последовательных узлах
+     * @param count Количество интервалов (не больше block_size)
+     * @return Бит i установлен, если values[i]·values[i + 1] < 0
+     */
+    static quint64 sign_changes(const double* values, int count);
+
+    /**
+     * @brief Микротест производительности
+     *
+     * Выводит в журнал число вычислений в секунду для каждого
+     * доступного набора инструкций
+     */
+    static void benchmark();
+};
+
+#endif // GRID_KERNEL_H
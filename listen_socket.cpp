@@ -0,0 +1,106 @@
+#include "../include/listen_socket.h"
+
+#ifdef Q_OS_UNIX
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Открывает прослушивающий сокет
+ * @param port Порт
+ * @param reuse_port Включить SO_REUSEPORT
+ * @return Сокет или -1
+ */
+qintptr listen_socket::open(quint16 port, bool reuse_port) {
+#ifdef Q_OS_UNIX
+    if (reuse_port && !reuse_port_supported()) {
+        return -1;
+    }
+
+    const int descriptor = socket(AF_INET, SOCK_STREAM, 0);
+    if (descriptor < 0) {
+        return -1;
+    }
+    fcntl(descriptor, F_SETFL, fcntl(descriptor, F_GETFL) | O_NONBLOCK);
+    fcntl(descriptor, F_SETFD, FD_CLOEXEC);
+
+    // Без SO_REUSEPORT сокеты потоков не смогут разделить порт, поэтому
+    // ошибка настройки равна ошибке открытия
+    const int enable = 1;
+    bool configured = setsockopt(descriptor, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) == 0;
+#ifdef SO_REUSEPORT
+    if (configured && reuse_port) {
+        configured = setsockopt(descriptor, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) == 0;
+    }
+#endif
+    if (!configured) {
+        ::close(descriptor);
+        return -1;
+    }
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(descriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+        || listen(descriptor, SOMAXCONN) != 0) {
+        ::close(descriptor);
+        return -1;
+    }
+    return descriptor;
+#else
+    Q_UNUSED(port);
+    Q_UNUSED(reuse_port);
+    return -1;
+#endif
+}
+
+/**
+ * @brief Проверяет, что порт не занят другим процессом
+ * @param port Порт
+ * @return true если порт свободен
+ *
+ * Пробный сокет открывается без SO_REUSEPORT: привязка к порту, который
+ * уже прослушивается (в том числе сокетами с SO_REUSEPORT), не удаётся
+ */
+bool listen_socket::port_available(quint16 port) {
+#ifdef Q_OS_UNIX
+    const qintptr probe = open(port, false);
+    if (probe < 0) {
+        return false;
+    }
+    close(probe);
+    return true;
+#else
+    Q_UNUSED(port);
+    return false;
+#endif
+}
+
+/**
+ * @brief Закрывает сокет
+ * @param descriptor Сокет
+ */
+void listen_socket::close(qintptr descriptor) {
+#ifdef Q_OS_UNIX
+    if (descriptor >= 0) {
+        ::close(int(descriptor));
+    }
+#else
+    Q_UNUSED(descriptor);
+#endif
+}
+
+/**
+ * @brief Проверяет поддержку SO_REUSEPORT
+ * @return true если опция доступна
+ */
+bool listen_socket::reuse_port_supported() {
+#if defined(Q_OS_UNIX) && defined(SO_REUSEPORT)
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,53 @@
+#ifndef LISTEN_SOCKET_H
+#define LISTEN_SOCKET_H
+
+#include <QtGlobal>
+
+/**
+ * @brief Открытие прослушивающих сокетов
+ *
+ * С SO_REUSEPORT на одном порту можно открыть несколько сокетов: ядро Linux
+ * распределяет входящие подключения между ними, и каждый поток
+ * ввода-вывода принимает подключения из своего сокета.
+ *
+ * Ядро разрешает это любому процессу того же пользователя, поэтому второй
+ * экземпляр сервера с SO_REUSEPORT не получил бы ошибку привязки, а молча
+ * забрал бы часть подключений. Перед открытием сокетов порт проверяется
+ * функцией port_available
+ */
+class listen_socket
+{
+public:
+    /**
+     * @brief Открытие сокета на всех адресах IPv4
+     * @param port Порт
+     * @param reuse_port Разрешить другие сокеты на этом порту (SO_REUSEPORT)
+     * @return Неблокирующий прослушивающий сокет или -1 при ошибке
+     */
+    static qintptr open(quint16 port, bool reuse_port);
+
+    /**
+     * @brief Проверка, что порт не прослушивает другой процесс
+     * @param port Порт
+     * @return true если порт свободен
+     *
+     * Между проверкой и открытием сокетов остаётся короткое окно, в которое
+     * другой процесс может занять порт; проверка защищает от повторного
+     * запуска сервера, а не от одновременного
+     */
+    static bool port_available(quint16 port);
+
+    /**
+     * @brief Закрытие сокета
+     * @param descriptor Сокет
+     */
+    static void close(qintptr descriptor);
+
+    /**
+     * @brief Поддержка SO_REUSEPORT на этой платформе
+     * @return true если несколько сокетов могут прослушивать один порт
+     */
+    static bool reuse_port_supported();
+};
+
+#endif // LISTEN_SOCKET_H
@@ -0,0 +1,79 @@
+#ifndef MESSAGE_TOKENIZER_H
+#define MESSAGE_TOKENIZER_H
+
+#include <QByteArrayView>
+#include <QVector>
+
+/**
+ * @brief Разбор сообщения "action|field|field" без выделения памяти
+ *
+ * Работает с принятыми байтами UTF-8 напрямую: за один проход запоминает
+ * границы полей и возвращает их как QByteArrayView на исходный буфер.
+ * Буфер должен существовать, пока используются поля. Поля с разделителем '$'
+ * разбиваются в массив представлений, числа разбираются std::from_chars
+ */
+class message_tokenizer
+{
+public:
+    static const int max_fields = 8; ///< Наибольшее число полей; последнее поле содержит остаток сообщения
+
+    /**
+     * @brief Разбор сообщения
+     * @param message Сообщение
+     */
+    explicit message_tokenizer(QByteArrayView message);
+
+    /**
+     * @brief Количество полей
+     * @return Число полей (не меньше 1)
+     */
+    int size() const;
+
+    /**
+     * @brief Поле сообщения
+     * @param index Номер поля (0 - действие)
+     * @return Поле или пустое представление, если поля нет
+     */
+    QByteArrayView field(int index) const;
+
+    /**
+     * @brief Разбиение поля по разделителю
+     * @param text Поле
+     * @param separator Разделитель
+     * @param parts Массив для частей
+     * @param capacity Размер массива
+     * @return Количество частей; сохраняются только первые capacity
+     */
+    static int split(QByteArrayView text, char separator, QByteArrayView* parts, int capacity);
+
+    /**
+     * @brief Разбор числа
+     * @param text Текст числа (допускаются пробелы по краям и знак '+')
+     * @param value Результат
+     * @return true если текст целиком является числом
+     */
+    static bool to_double(QByteArrayView text, double& value);
+
+    /**
+     * @brief Разбор списка чисел
+     * @param text Поле с числами
+     * @param separator Разделитель чисел
+     * @param values Результат
+     * @return true если все числа разобраны
+     */
+    static bool to_doubles(QByteArrayView text, char separator, QVector<double>& values);
+
+    /**
+     * @brief Микротест производительности
+     *
+     * Выводит в журнал число разобранных сообщений в секунду для
+     * разбора через QString::split и для message_tokenizer
+     */
+    static void benchmark();
+
+private:
+    QByteArrayView fields[max_fields]; ///< Границы полей
+    int count = 0;                     ///< Количество полей
+};
+
+#endif // MESSAGE_TOKENIZER_H
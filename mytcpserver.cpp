@@ -4,6 +4,11 @@
 #include <QString>
 #include <QThread>
 #include "../include/client_object.h"
+#include "../include/listen_socket.h"
+#include "../include/dbsingleton.h"
+#include "../include/grid_kernel.h"
+#include "../include/quadratic_batch.h"
+#include "../include/message_tokenizer.h"
 
 /// Статические члены класса
 MyTcpServer* MyTcpServer::p_instance = nullptr;
@@ -40,21 +45,92 @@ MyTcpServerDestroyer::~MyTcpServerDestroyer() {
  */
 MyTcpServer::~MyTcpServer()
 {
-    // Удаление всех клиентов
-    for (int i = 0; i < clients.size(); i++) {
-        delete clients[i];
+    if (mTcpServer != nullptr) {
+        mTcpServer->close(); // Закрываем серверный сокет
     }
-    mTcpServer->close(); // Закрываем серверный сокет
-    delete mTcpServer;
+
+    result_cache::counters cache = servers_functions->cache_statistics();
+    qDebug() << QString("%1 Кэш решений: попаданий %2, промахов %3, вытеснений %4, присоединённых запросов %5")
+                    .arg(servers_functions->get_server_time())
+                    .arg(cache.hits)
+                    .arg(cache.misses)
+                    .arg(cache.evictions)
+                    .arg(servers_functions->coalesced_requests());
+    qDebug() << QString("%1 Отклонено подключений сверх предела: %2")
+                    .arg(servers_functions->get_server_time())
+                    .arg(reactors != nullptr ? reactors->refused_connections() : refused_connections.load());
+
+    // Реакторы закрывают свои соединения сами
+    delete reactors;
+    if (workers != nullptr) {
+        // Останавливаем потоки, после чего клиентов можно безопасно удалить
+        workers->stop();
+        const QList<client*> connected_clients = clients;
+        for (int i = 0; i < connected_clients.size(); i++) {
+            delete connected_clients[i];
+        }
+        qDeleteAll(listeners);
+        delete mTcpServer;
+    }
+
+    // Потоки ввода-вывода больше не арендуют соединения и не ставят
+    // изменения в очередь записи, поэтому базу можно закрыть
+    DBSingleton::shutdown();
 }
 
 /**
  * @brief Конструктор сервера
+ * @param workers_count Количество потоков ввода-вывода
+ * @param solver_threads Количество потоков решателя уравнений
+ * @param cache_budget Бюджет кэша готовых ответов в байтах
+ * @param max_connections Наибольшее число одновременных подключений
+ * @param timeouts Тайм-ауты подключений
+ * @param backend Сетевая подсистема
+ * @param reuse_port Отдельный прослушивающий сокет у каждого потока
  * @param parent Родительский объект
  *
- * Инициализирует TCP сервер и начинает прослушивание порта
+ * Инициализирует пулы потоков, кэш ответов, TCP сервер и начинает прослушивание порта.
+ * Если epoll_server не удалось запустить, используется QTcpServer. Если не удалось
+ * открыть сокеты с SO_REUSEPORT, подключения принимает один QTcpServer
  */
-MyTcpServer::MyTcpServer(QObject *parent) : QObject(parent) {
+MyTcpServer::MyTcpServer(int workers_count, int solver_threads, qint64 cache_budget, int max_connections,
+                         const connection_timeouts& timeouts, network_backend backend, bool reuse_port,
+                         QObject *parent)
+    : QObject(parent), max_connections(qMax(1, max_connections)), timeouts(timeouts) {
+    // Контекст запроса передаётся между потоками через queued-соединения
+    qRegisterMetaType<request_context>("request_context");
+
+    DBSingleton::getInstance(workers_count); // Пул соединений с базой по числу потоков ввода-вывода
+    servers_functions->start_solver_pool(solver_threads); // Потоки решателя отдельно от потоков ввода-вывода
+    servers_functions->start_result_cache(cache_budget); // Повторные уравнения не решаются заново
+
+    if (backend == network_backend::EPOLL) {
+        reactors = new epoll_server(8080, workers_count, this->max_connections, timeouts, reuse_port);
+        if (reactors->is_listening()) {
+            qDebug() << QString("%1 Сервер успешно запущен (epoll). Потоков обработки: %2")
+                            .arg(servers_functions->get_server_time())
+                            .arg(reactors->size());
+            return;
+        }
+        qDebug() << QString("%1 Не удалось запустить epoll, используется QTcpServer")
+                        .arg(servers_functions->get_server_time());
+        delete reactors;
+        reactors = nullptr;
+    }
+
+    workers = new worker_pool(workers_count, this); // Создаем пул потоков
+
+    if (reuse_port) {
+        if (start_listeners()) {
+            qDebug() << QString("%1 Сервер успешно запущен (SO_REUSEPORT). Потоков обработки: %2")
+                            .arg(servers_functions->get_server_time())
+                            .arg(workers->size());
+            return;
+        }
+        qDebug() << QString("%1 Не удалось открыть сокеты с SO_REUSEPORT, используется один QTcpServer")
+                        .arg(servers_functions->get_server_time());
+    }
+
     mTcpServer = new QTcpServer(this); // Создаем экземпляр сервера
 
     // Настраиваем обработку новых подключений
@@ -65,44 +141,185 @@ MyTcpServer::MyTcpServer(QObject *parent) : QObject(parent) {
     if(!mTcpServer->listen(QHostAddress::Any, 8080)) {
         qDebug() << QString("%1 Сервер не запущен!").arg(servers_functions->get_server_time());
     } else {
-        qDebug() << QString("%1 Сервер успешно запущен").arg(servers_functions->get_server_time());
+        qDebug() << QString("%1 Сервер успешно запущен. Потоков обработки: %2")
+                        .arg(servers_functions->get_server_time())
+                        .arg(workers->size());
     }
 }
 
 /**
  * @brief Создает или возвращает экземпляр сервера (реализация Singleton)
+ * @param workers_count Количество потоков ввода-вывода (0 - по числу ядер)
+ * @param solver_threads Количество потоков решателя уравнений (0 - по числу ядер)
+ * @param cache_budget Бюджет кэша готовых ответов в байтах (0 - без кэша)
+ * @param max_connections Наибольшее число одновременных подключений
+ * @param timeouts Тайм-ауты подключений
+ * @param backend Сетевая подсистема
+ * @param reuse_port Отдельный прослушивающий сокет у каждого потока ввода-вывода
  * @return Указатель на экземпляр сервера
  */
-MyTcpServer* MyTcpServer::create_instance() {
+MyTcpServer* MyTcpServer::create_instance(int workers_count, int solver_threads, qint64 cache_budget,
+                                          int max_connections, const connection_timeouts& timeouts,
+                                          network_backend backend, bool reuse_port) {
     if (MyTcpServer::p_instance == nullptr) {
-        MyTcpServer::p_instance = new MyTcpServer;
+        MyTcpServer::p_instance = new MyTcpServer(workers_count, solver_threads, cache_budget,
+                                                  max_connections, timeouts, backend, reuse_port);
         MyTcpServerDestroyer::destroyer.initialize(MyTcpServer::p_instance, functions_for_server::get_instance());
+        // База данных закрывается в деструкторе сервера после остановки потоков
+        DBSingleton::detach_destroyer();
     }
     return MyTcpServer::p_instance;
 }
 
+/**
+ * @brief Выбор сетевой подсистемы по аргументам командной строки
+ * @param arguments Аргументы командной строки
+ * @return Сетевая подсистема
+ */
+network_backend MyTcpServer::backend_from_arguments(const QStringList& arguments) {
+    return arguments.contains("--backend=epoll") ? network_backend::EPOLL : network_backend::QT;
+}
+
+/**
+ * @brief Режим SO_REUSEPORT по аргументам командной строки
+ * @param arguments Аргументы командной строки
+ * @return true при наличии "--reuse-port"
+ */
+bool MyTcpServer::reuse_port_from_arguments(const QStringList& arguments) {
+    return arguments.contains("--reuse-port");
+}
+
+/**
+ * @brief Запуск микротестов по аргументам командной строки
+ * @param arguments Аргументы командной строки
+ * @return true если микротесты выполнены
+ *
+ * Замер авторизации открывает базу данных и закрывает её после себя
+ */
+bool MyTcpServer::benchmark_from_arguments(const QStringList& arguments) {
+    if (!arguments.contains("--benchmark")) {
+        return false;
+    }
+    grid_kernel::benchmark(); // Скалярный проход сетки против SSE2 и AVX2
+    quadratic_batch::benchmark(); // Пакет уравнений в одном потоке: скалярное ядро против AVX2
+    message_tokenizer::benchmark(); // Разбор сообщений: QString::split против message_tokenizer
+    DBSingleton::getInstance()->benchmark_auth(); // Проверка пароля: текстовый запрос против подготовленного
+    DBSingleton::shutdown();
+    return true;
+}
+
+/**
+ * @brief Запуск слушателей в потоках пула
+ * @return true если все слушатели запущены
+ *
+ * Для каждого потока открывается свой сокет с SO_REUSEPORT, и ядро
+ * распределяет между ними входящие подключения. Слушатель переносится
+ * в поток до установки дескриптора, чтобы уведомления сокета
+ * обрабатывал цикл событий этого потока.
+ *
+ * Сокеты с SO_REUSEPORT может открыть и другой процесс того же
+ * пользователя, поэтому сначала проверяется, что порт свободен: иначе
+ * второй экземпляр сервера разделил бы подключения с первым вместо
+ * ошибки запуска
+ */
+bool MyTcpServer::start_listeners() {
+    if (!listen_socket::port_available(8080)) {
+        qDebug() << QString("%1 Порт 8080 уже занят другим процессом")
+                        .arg(servers_functions->get_server_time());
+        return false;
+    }
+    for (int i = 0; i < workers->size(); i++) {
+        const qintptr descriptor = listen_socket::open(8080, true);
+        if (descriptor < 0) {
+            break;
+        }
+
+        worker_listener* listener = new worker_listener(this, timeouts);
+        listener->moveToThread(workers->at(i));
+        listeners.push_back(listener);
+
+        bool started = false;
+        QMetaObject::invokeMethod(listener, [listener, descriptor]() {
+            return listener->setSocketDescriptor(descriptor);
+        }, Qt::BlockingQueuedConnection, &started);
+        if (!started) {
+            listen_socket::close(descriptor);
+            break;
+        }
+    }
+
+    if (listeners.size() == workers->size()) {
+        return true;
+    }
+
+    // Слушатели закрываются в своих потоках, подключений у них ещё нет
+    for (worker_listener* listener : listeners) {
+        QMetaObject::invokeMethod(listener, [listener]() {
+            delete listener;
+        }, Qt::BlockingQueuedConnection);
+    }
+    listeners.clear();
+    return false;
+}
+
+/**
+ * @brief Учёт нового подключения
+ * @return true если подключение принято
+ */
+bool MyTcpServer::admit_connection() {
+    if (active_connections.fetch_add(1) < max_connections) {
+        return true;
+    }
+    active_connections.fetch_sub(1);
+    refused_connections.fetch_add(1);
+    if (!saturated.exchange(true)) {
+        qDebug() << QString("%1 Достигнут предел подключений (%2), новые подключения отклоняются")
+                        .arg(servers_functions->get_server_time())
+                        .arg(max_connections);
+    }
+    return false;
+}
+
+/**
+ * @brief Учёт закрытого подключения
+ */
+void MyTcpServer::release_connection() {
+    const int remaining = active_connections.fetch_sub(1) - 1;
+    if (remaining < max_connections && saturated.exchange(false)) {
+        qDebug() << QString("%1 Число подключений ниже предела, приём возобновлён. Отклонено: %2")
+                        .arg(servers_functions->get_server_time())
+                        .arg(refused_connections.load());
+    }
+}
+
 /**
  * @brief Обработчик новых подключений
  *
- * Создает новый поток для каждого подключившегося клиента
+ * Переносит клиента в наименее загруженный поток из пула. Сверх предела
+ * max_connections подключение получает сообщение busy и закрывается;
+ * уже подключённые клиенты при этом не затрагиваются
  */
 void MyTcpServer::slotNewConnection() {
-    // Создаем новый поток для клиента
-    QThread* new_thread_for_client = new QThread(this);
-
     // Получаем сокет нового клиента
     QTcpSocket* temp = this->mTcpServer->nextPendingConnection();
 
-    // Создаем объект клиента
-    client* client_object = new client(temp->socketDescriptor());
+    if (!admit_connection()) {
+        connect(temp, &QTcpSocket::disconnected, temp, &QObject::deleteLater);
+        temp->write(frame_buffer::busy);
+        temp->disconnectFromHost();
+        return;
+    }
 
-    // Переносим клиента в новый поток
-    client_object->moveToThread(new_thread_for_client);
+    // Создаем объект клиента
+    client* client_object = new client(temp->socketDescriptor(), timeouts);
 
-    // Настраиваем сигналы для управления жизненным циклом потока
-    connect(client_object, &client::del_thread, new_thread_for_client, &QThread::quit);
-    connect(new_thread_for_client, &QThread::finished, client_object, &QThread::deleteLater);
+    // Переносим клиента в наименее загруженный поток
+    QThread* worker = workers->acquire();
+    client_object->moveToThread(worker);
 
-    // Запускаем поток
-    new_thread_for_client->start();
+    // После удаления клиента освобождаем место в потоке
+    connect(client_object, &QObject::destroyed, this, [this, worker]() {
+        workers->release(worker);
+        release_connection();
+    });
 }
@@ -8,7 +8,21 @@
 #include <QByteArray>
 #include <QDebug>
 #include <QList>
+#include <QVector>
+#include <atomic>
 #include "functions_for_server.h"
+#include "worker_pool.h"
+#include "client_object.h"
+#include "epoll_server.h"
+#include "worker_listener.h"
+
+/**
+ * @brief Сетевая подсистема сервера
+ */
+enum class network_backend {
+    QT,    ///< QTcpServer и объект client на каждое соединение
+    EPOLL, ///< epoll_server: реакторы epoll без цикла событий Qt (только Linux)
+};
 
 // Предварительное объявление класса MyTcpServer
 class MyTcpServer;
@@ -51,9 +65,45 @@ class MyTcpServer : public QObject
 public:
     /**
      * @brief Получение или создание экземпляра сервера
+     * @param workers_count Количество потоков ввода-вывода (0 - по числу ядер)
+     * @param solver_threads Количество потоков решателя уравнений (0 - по числу ядер)
+     * @param cache_budget Бюджет кэша готовых ответов в байтах (0 - без кэша)
+     * @param max_connections Наибольшее число одновременных подключений
+     * @param timeouts Тайм-ауты простоя и чтения для каждого подключения
+     * @param backend Сетевая подсистема
+     * @param reuse_port Отдельный прослушивающий сокет (SO_REUSEPORT) у каждого потока ввода-вывода
+     *
+     * Параметры учитываются только при первом вызове
      * @return Указатель на единственный экземпляр
      */
-    static MyTcpServer* create_instance();
+    static MyTcpServer* create_instance(int workers_count = 0, int solver_threads = 0,
+                                        qint64 cache_budget = 16 * 1024 * 1024,
+                                        int max_connections = 1024,
+                                        const connection_timeouts& timeouts = connection_timeouts(),
+                                        network_backend backend = network_backend::QT,
+                                        bool reuse_port = false);
+
+    /**
+     * @brief Выбор сетевой подсистемы по аргументам командной строки
+     * @param arguments Аргументы (QCoreApplication::arguments())
+     * @return EPOLL при наличии "--backend=epoll", иначе QT
+     */
+    static network_backend backend_from_arguments(const QStringList& arguments);
+
+    /**
+     * @brief Режим SO_REUSEPORT по аргументам командной строки
+     * @param arguments Аргументы (QCoreApplication::arguments())
+     * @return true при наличии "--reuse-port"
+     */
+    static bool reuse_port_from_arguments(const QStringList& arguments);
+
+    /**
+     * @brief Запуск микротестов по аргументам командной строки
+     * @param arguments Аргументы (QCoreApplication::arguments())
+     * @return true при наличии "--benchmark": результаты выведены в журнал,
+     *         и сервер можно не запускать
+     */
+    static bool benchmark_from_arguments(const QStringList& arguments);
 
     /**
      * @brief Деструктор
@@ -67,15 +117,55 @@ private slots:
     void slotNewConnection();
 
 private:
+    friend class worker_listener;
+
     static MyTcpServer* p_instance;        ///< Указатель на экземпляр синглтона
-    QTcpServer* mTcpServer;               ///< Экземпляр QTcpServer
+    QTcpServer* mTcpServer = nullptr;     ///< Экземпляр QTcpServer (подсистема QT)
     QTcpSocket* temp;                     ///< Временное хранилище сокета
+    worker_pool* workers = nullptr;       ///< Пул потоков для обслуживания клиентов (подсистема QT)
+    epoll_server* reactors = nullptr;     ///< Реакторы epoll (подсистема EPOLL)
+    QVector<worker_listener*> listeners;  ///< Слушатели потоков пула (подсистема QT с reuse_port)
+    int max_connections;                  ///< Наибольшее число одновременных подключений
+    connection_timeouts timeouts;         ///< Тайм-ауты новых подключений
+    std::atomic<int> active_connections{0};      ///< Текущее число подключений
+    std::atomic<quint64> refused_connections{0}; ///< Число отклонённых подключений
+    std::atomic<bool> saturated{false};          ///< Предел подключений достигнут
 
     /**
      * @brief Приватный конструктор
+     * @param workers_count Количество потоков ввода-вывода
+     * @param solver_threads Количество потоков решателя уравнений
+     * @param cache_budget Бюджет кэша готовых ответов в байтах
+     * @param max_connections Наибольшее число одновременных подключений
+     * @param timeouts Тайм-ауты подключений
+     * @param backend Сетевая подсистема
+     * @param reuse_port Отдельный прослушивающий сокет у каждого потока
      * @param parent Родительский QObject
      */
-    explicit MyTcpServer(QObject* parent = nullptr);
+    explicit MyTcpServer(int workers_count, int solver_threads, qint64 cache_budget, int max_connections,
+                         const connection_timeouts& timeouts, network_backend backend, bool reuse_port,
+                         QObject* parent = nullptr);
+
+    /**
+     * @brief Запуск слушателей в потоках пула
+     * @return true если каждый поток открыл свой сокет на порту 8080
+     */
+    bool start_listeners();
+
+    /**
+     * @brief Учёт нового подключения
+     * @return false если достигнут предел и подключение следует отклонить
+     *
+     * Может вызываться из любого потока
+     */
+    bool admit_connection();
+
+    /**
+     * @brief Учёт закрытого подключения
+     *
+     * Может вызываться из любого потока
+     */
+    void release_connection();
 
     MyTcpServer(const MyTcpServer&) = delete;  ///< Запрет копирования
 };
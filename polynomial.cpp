@@ -0,0 +1,597 @@
+#include "../include/polynomial.h"
+#include <QtGlobal>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/// Относительный уровень, ниже которого коэффициенты остатка считаются ошибкой округления
+static const double sturm_noise = 1e-10;
+/// Наибольшее число итераций уточнения одного корня
+static const int max_iterations = 200;
+
+/**
+ * @brief Нормирует многочлен на наибольший по модулю коэффициент
+ * @param source Исходный многочлен
+ * @param sign Множитель знака (1 или -1)
+ * @return Многочлен с теми же корнями и коэффициентами не больше 1 по модулю
+ */
+static polynomial normalized(const polynomial& source, double sign) {
+    QVector<double> coefficients = source.coefficients();
+    double scale = 0;
+    for (double coefficient : coefficients) {
+        scale = std::max(scale, std::abs(coefficient));
+    }
+    for (double& coefficient : coefficients) {
+        coefficient = sign * coefficient / scale;
+    }
+    return polynomial(coefficients);
+}
+
+/**
+ * @brief Конструктор многочлена
+ * @param coefficients Коэффициенты, начиная со старшей степени
+ */
+polynomial::polynomial(const QVector<double>& coefficients) {
+    int lead = 0;
+    while (lead < coefficients.size() && qFuzzyIsNull(coefficients[lead])) {
+        lead++;
+    }
+    for (int i = lead; i < coefficients.size(); i++) {
+        coeffs.push_back(coefficients[i]);
+    }
+}
+
+/**
+ * @brief Возвращает степень многочлена
+ * @return Степень (-1 для нулевого многочлена)
+ */
+int polynomial::degree() const {
+    return coeffs.size() - 1;
+}
+
+/**
+ * @brief Возвращает коэффициенты многочлена
+ * @return Коэффициенты, начиная со старшей степени
+ */
+const QVector<double>& polynomial::coefficients() const {
+    return coeffs;
+}
+
+/**
+ * @brief Вычисляет значение многочлена по схеме Горнера
+ * @param x Значение переменной
+ * @return p(x)
+ */
+double polynomial::value(double x) const {
+    double result = 0;
+    for (double coefficient : coeffs) {
+        result = result * x + coefficient;
+    }
+    return result;
+}
+
+/**
+ * @brief Вычисляет производную многочлена
+ * @return p'(x)
+ */
+polynomial polynomial::derivative() const {
+    QVector<double> result;
+    const int n = degree();
+    for (int i = 0; i < n; i++) {
+        result.push_back(coeffs[i] * double(n - i));
+    }
+    return polynomial(result);
+}
+
+/**
+ * @brief Вычисляет границу модулей корней
+ * @return Граница R
+ *
+ * Оценка Коши: 1 + max|a_k / a_n|.
+ * Оценка Фудзивары: 2·max(|a_(n-1) / a_n|, |a_(n-2) / a_n|^(1/2), ..., |a_0 / 2a_n|^(1/n))
+ */
+double polynomial::root_bound() const {
+    const int n = degree();
+    if (n <= 0) {
+        return 0;
+    }
+
+    const double leading = coeffs[0];
+    double cauchy = 0;
+    double fujiwara = 0;
+    for (int k = 1; k <= n; k++) {
+        double ratio = std::abs(coeffs[k] / leading);
+        cauchy = std::max(cauchy, ratio);
+        if (k == n) {
+            ratio /= 2;
+        }
+        fujiwara = std::max(fujiwara, std::pow(ratio, 1.0 / k));
+    }
+    return std::min(1 + cauchy, 2 * fujiwara);
+}
+
+/**
+ * @brief Вычисляет остаток от деления многочленов
+ * @param dividend Делимое
+ * @param divisor Делитель (ненулевой)
+ * @return Остаток
+ */
+polynomial polynomial::remainder(const polynomial& dividend, const polynomial& divisor) {
+    QVector<double> rest = dividend.coeffs;
+    const int n = divisor.degree();
+    if (n < 0 || rest.size() <= n) {
+        return dividend;
+    }
+
+    double scale = 0;
+    for (double coefficient : rest) {
+        scale = std::max(scale, std::abs(coefficient));
+    }
+
+    for (int i = 0; i + n < rest.size(); i++) {
+        double factor = rest[i] / divisor.coeffs[0];
+        for (int j = 0; j <= n; j++) {
+            rest[i + j] -= factor * divisor.coeffs[j];
+        }
+        rest[i] = 0;
+    }
+
+    QVector<double> tail;
+    for (int i = rest.size() - n; i < rest.size(); i++) {
+        tail.push_back(std::abs(rest[i]) <= sturm_noise * scale ? 0 : rest[i]);
+    }
+    return polynomial(tail);
+}
+
+/**
+ * @brief Строит последовательность Штурма
+ * @return Последовательность p, p', -rem(p, p'), ...
+ *
+ * Если у многочлена есть кратные корни, последний член равен НОД(p, p'),
+ * и число перемен знака по-прежнему даёт число различных корней
+ */
+QVector<polynomial> polynomial::sturm_sequence() const {
+    QVector<polynomial> sequence;
+    if (degree() < 0) {
+        return sequence;
+    }
+
+    sequence.push_back(normalized(*this, 1));
+    polynomial first_derivative = derivative();
+    if (first_derivative.degree() < 0) {
+        return sequence;
+    }
+    sequence.push_back(normalized(first_derivative, 1));
+
+    while (sequence.last().degree() > 0) {
+        polynomial rest = remainder(sequence[sequence.size() - 2], sequence.last());
+        if (rest.degree() < 0) {
+            break;
+        }
+        sequence.push_back(normalized(rest, -1));
+    }
+    return sequence;
+}
+
+/**
+ * @brief Считает перемены знака последовательности Штурма
+ * @param sequence Последовательность Штурма
+ * @param x Точка
+ * @return Число перемен знака
+ */
+int polynomial::sign_changes(const QVector<polynomial>& sequence, double x) {
+    int changes = 0;
+    double previous = 0;
+    for (const polynomial& member : sequence) {
+        double current = member.value(x);
+        if (current == 0) {
+            continue;
+        }
+        if (previous != 0 && (current < 0) != (previous < 0)) {
+            changes++;
+        }
+        previous = current;
+    }
+    return changes;
+}
+
+/**
+ * @brief Оценивает ошибку округления при вычислении p(x) по схеме Горнера
+ * @param x Значение переменной
+ * @return 4n·ε·Σ|a_k|·|x|^k
+ */
+double polynomial::rounding_error(double x) const {
+    const double magnitude = std::abs(x);
+    double sum = 0;
+    for (double coefficient : coeffs) {
+        sum = sum * magnitude + std::abs(coefficient);
+    }
+    return 4 * std::max(1, degree()) * std::numeric_limits<double>::epsilon() * sum;
+}
+
+/**
+ * @brief Проверяет, достигнута ли относительная точность
+ * @param left Левая граница отрезка
+ * @param right Правая граница отрезка
+ * @param tolerance Относительная точность
+ * @return true если ширина отрезка не больше tolerance·max(|left|, |right|)
+ *
+ * Отрезок, внутри которого не осталось представимых чисел, тоже считается сошедшимся
+ */
+bool polynomial::converged(double left, double right, double tolerance) {
+    const double mid = left + (right - left) / 2;
+    return right - left <= tolerance * std::max(std::abs(left), std::abs(right))
+           || mid <= left || mid >= right;
+}
+
+/**
+ * @brief Находит действительные корни многочлена
+ * @param method Способ уточнения корня
+ * @param tolerance Относительная точность
+ * @param stats Счётчики затрат (может быть nullptr)
+ * @return Различные корни по возрастанию
+ *
+ * Отрезок [-R, R] делится пополам только там, где по теореме Штурма
+ * находится больше одного корня. Отрезки с единственным корнем
+ * передаются на уточнение
+ */
+QVector<double> polynomial::real_roots(refinement method, double tolerance, statistics* stats) const {
+    QVector<double> roots;
+    if (degree() <= 0) {
+        return roots;
+    }
+
+    statistics local;
+    statistics& counters = stats ? *stats : local;
+    QVector<polynomial> sequence = sturm_sequence();
+    const double bound = root_bound() * 1.01 + 1e-9;
+    counters.evaluations += 2 * sequence.size();
+    isolate(sequence, -bound, bound, sign_changes(sequence, -bound), sign_changes(sequence, bound),
+            method, tolerance, counters, roots);
+    return roots;
+}
+
+/**
+ * @brief Отделяет корни на отрезке (left, right]
+ * @param sequence Последовательность Штурма
+ * @param left Левая граница
+ * @param right Правая граница
+ * @param changes_left Число перемен знака в left
+ * @param changes_right Число перемен знака в right
+ * @param method Способ уточнения корня
+ * @param tolerance Относительная точность
+ * @param stats Счётчики затрат
+ * @param roots Вектор найденных корней
+ */
+void polynomial::isolate(const QVector<polynomial>& sequence, double left, double right,
+                         int changes_left, int changes_right, refinement method, double tolerance,
+                         statistics& stats, QVector<double>& roots) const {
+    const int count = changes_left - changes_right;
+    if (count <= 0) {
+        return;
+    }
+    if (count == 1) {
+        roots.push_back(refine(sequence, left, right, method, tolerance, stats));
+        return;
+    }
+
+    // Корни, неразличимые с заданной точностью, считаются одним
+    if (converged(left, right, tolerance)) {
+        roots.push_back((left + right) / 2);
+        return;
+    }
+
+    const double mid = (left + right) / 2;
+    const int changes_mid = sign_changes(sequence, mid);
+    stats.evaluations += sequence.size();
+    isolate(sequence, left, mid, changes_left, changes_mid, method, tolerance, stats, roots);
+    isolate(sequence, mid, right, changes_mid, changes_right, method, tolerance, stats, roots);
+}
+
+/**
+ * @brief Уточняет единственный корень на отрезке (left, right]
+ * @param sequence Последовательность Штурма
+ * @param left Левая граница
+ * @param right Правая граница
+ * @param method Способ уточнения корня
+ * @param tolerance Относительная точность
+ * @param stats Счётчики затрат
+ * @return Корень
+ *
+ * Пока знак многочлена на концах совпадает (корень чётной кратности),
+ * отрезок сужается по числу перемен знака. После появления смены знака
+ * корень уточняется выбранным методом
+ */
+double polynomial::refine(const QVector<polynomial>& sequence, double left, double right,
+                          refinement method, double tolerance, statistics& stats) const {
+    double f_left = value(left);
+    double f_right = value(right);
+    stats.evaluations += 2;
+    if (std::abs(f_right) <= rounding_error(right)) {
+        return right;
+    }
+
+    int changes_left = sign_changes(sequence, left);
+    stats.evaluations += sequence.size();
+    while (!(f_left * f_right < 0)) {
+        if (converged(left, right, tolerance)) {
+            return (left + right) / 2;
+        }
+        stats.iterations++;
+        double mid = (left + right) / 2;
+        int changes_mid = sign_changes(sequence, mid);
+        stats.evaluations += sequence.size() + 1;
+        if (changes_left - changes_mid >= 1) {
+            right = mid;
+            f_right = value(mid);
+            if (std::abs(f_right) <= rounding_error(mid)) {
+                return mid;
+            }
+        } else {
+            left = mid;
+            f_left = value(mid);
+            changes_left = changes_mid;
+        }
+    }
+
+    return solve_bracket(left, right, f_left, f_right, method, tolerance, &stats);
+}
+
+/**
+ * @brief Уточняет корень на отрезке со сменой знака
+ * @param left Левая граница
+ * @param right Правая граница
+ * @param f_left Значение в left
+ * @param f_right Значение в right
+ * @param method Способ уточнения
+ * @param tolerance Относительная точность
+ * @param stats Счётчики затрат (может быть nullptr)
+ * @return Корень
+ *
+ * Итерации прекращаются, когда отрезок сужен до относительной точности
+ * или |p(x)| не превышает ошибки округления в точке x
+ */
+double polynomial::solve_bracket(double left, double right, double f_left, double f_right,
+                                 refinement method, double tolerance, statistics* stats) const {
+    statistics local;
+    statistics& counters = stats ? *stats : local;
+
+    switch (method) {
+    case refinement::BRENT:
+        return brent(left, right, f_left, f_right, tolerance, counters);
+
+    case refinement::ILLINOIS: {
+        // Ложное положение; если один конец остаётся неподвижным два шага подряд,
+        // его значение делится пополам, чтобы секущая не застревала
+        int side = 0;
+        double x = left;
+        for (int iteration = 0; iteration < max_iterations; iteration++) {
+            counters.iterations++;
+            double next = (left * f_right - right * f_left) / (f_right - f_left);
+            if (!(next > left && next < right)) {
+                next = (left + right) / 2;
+            }
+            double f_next = value(next);
+            counters.evaluations++;
+            if (std::abs(f_next) <= rounding_error(next)) {
+                return next;
+            }
+            if ((f_next < 0) == (f_right < 0)) {
+                right = next;
+                f_right = f_next;
+                if (side == -1) {
+                    f_left /= 2;
+                }
+                side = -1;
+            } else {
+                left = next;
+                f_left = f_next;
+                if (side == 1) {
+                    f_right /= 2;
+                }
+                side = 1;
+            }
+            if (converged(left, right, tolerance) || converged(std::min(x, next), std::max(x, next), tolerance)) {
+                return next;
+            }
+            x = next;
+        }
+        return x;
+    }
+
+    case refinement::NEWTON: {
+        // Шаг Ньютона, вышедший за отрезок, заменяется бисекцией
+        const polynomial slope = derivative();
+        double x = (left + right) / 2;
+        for (int iteration = 0; iteration < max_iterations; iteration++) {
+            counters.iterations++;
+            double f_x = value(x);
+            counters.evaluations++;
+            if (std::abs(f_x) <= rounding_error(x)) {
+                return x;
+            }
+            if ((f_x < 0) == (f_left < 0)) {
+                left = x;
+                f_left = f_x;
+            } else {
+                right = x;
+            }
+
+            double next = x - f_x / slope.value(x);
+            counters.evaluations++;
+            if (!(next > left && next < right)) {
+                next = (left + right) / 2;
+            }
+            if (converged(std::min(x, next), std::max(x, next), tolerance) || converged(left, right, tolerance)) {
+                return next;
+            }
+            x = next;
+        }
+        return x;
+    }
+
+    default:
+        while (!converged(left, right, tolerance)) {
+            counters.iterations++;
+            double mid = (left + right) / 2;
+            double f_mid = value(mid);
+            counters.evaluations++;
+            if (std::abs(f_mid) <= rounding_error(mid)) {
+                return mid;
+            }
+            if ((f_mid < 0) == (f_left < 0)) {
+                left = mid;
+                f_left = f_mid;
+            } else {
+                right = mid;
+            }
+        }
+        return (left + right) / 2;
+    }
+}
+
+/**
+ * @brief Находит критические точки многочлена
+ * @param tolerance Относительная точность
+ * @param stats Счётчики затрат (может быть nullptr)
+ * @return Корни производной по возрастанию
+ */
+QVector<double> polynomial::critical_points(double tolerance, statistics* stats) const {
+    return derivative().real_roots(refinement::NEWTON, tolerance, stats);
+}
+
+/**
+ * @brief Находит кратные корни многочлена
+ * @param tolerance Относительная точность
+ * @param stats Счётчики затрат (может быть nullptr)
+ * @return Кратные корни по возрастанию
+ *
+ * Для квадратного трёхчлена это одно вычисление в вершине параболы
+ * независимо от сетки, на которой ищутся остальные корни
+ */
+QVector<polynomial::root> polynomial::tangent_roots(double tolerance, statistics* stats) const {
+    QVector<root> result;
+    if (degree() < 2) {
+        return result;
+    }
+
+    statistics local;
+    statistics& counters = stats ? *stats : local;
+    const polynomial slope = derivative();
+    const QVector<root> slope_tangents = slope.tangent_roots(tolerance, &counters);
+
+    for (double x : slope.real_roots(refinement::NEWTON, tolerance, &counters)) {
+        counters.evaluations++;
+        if (std::abs(value(x)) <= rounding_error(x)) {
+            result.push_back({x, multiplicity(slope_tangents, x, tolerance) + 1});
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Находит действительные корни с кратностью
+ * @param method Способ уточнения корня
+ * @param tolerance Относительная точность
+ * @param stats Счётчики затрат (может быть nullptr)
+ * @return Корни по возрастанию
+ */
+QVector<polynomial::root> polynomial::roots(refinement method, double tolerance, statistics* stats) const {
+    QVector<root> result;
+    const QVector<root> tangents = tangent_roots(tolerance, stats);
+    for (double x : real_roots(method, tolerance, stats)) {
+        result.push_back({x, multiplicity(tangents, x, tolerance)});
+    }
+    return result;
+}
+
+/**
+ * @brief Определяет кратность корня по списку кратных корней
+ * @param tangents Кратные корни
+ * @param x Корень
+ * @param tolerance Относительная точность
+ * @return Кратность
+ */
+int polynomial::multiplicity(const QVector<root>& tangents, double x, double tolerance) {
+    for (const root& tangent : tangents) {
+        const double limit = std::pow(tolerance, 1.0 / tangent.multiplicity) * std::max(1.0, std::abs(x));
+        if (std::abs(tangent.value - x) <= limit) {
+            return tangent.multiplicity;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Уточняет корень методом Брента
+ * @param left Левая граница
+ * @param right Правая граница
+ * @param f_left Значение в left
+ * @param f_right Значение в right
+ * @param tolerance Относительная точность
+ * @param stats Счётчики затрат
+ * @return Корень
+ *
+ * Обратная квадратичная интерполяция или секущая, если шаг
+ * сокращает отрезок достаточно быстро, иначе бисекция
+ */
+double polynomial::brent(double left, double right, double f_left, double f_right,
+                         double tolerance, statistics& stats) const {
+    double a = left, b = right, c = left;
+    double fa = f_left, fb = f_right, fc = f_left;
+    double d = b - a, e = d;
+
+    for (int iteration = 0; iteration < max_iterations; iteration++) {
+        stats.iterations++;
+        if ((fb < 0) == (fc < 0)) {
+            c = a;
+            fc = fa;
+            d = e = b - a;
+        }
+        if (std::abs(fc) < std::abs(fb)) {
+            a = b; b = c; c = a;
+            fa = fb; fb = fc; fc = fa;
+        }
+
+        const double limit = 2 * std::numeric_limits<double>::epsilon() * std::abs(b)
+                             + 0.5 * tolerance * std::abs(b);
+        const double half = (c - b) / 2;
+        if (std::abs(half) <= limit || std::abs(fb) <= rounding_error(b)) {
+            return b;
+        }
+
+        if (std::abs(e) >= limit && std::abs(fa) > std::abs(fb)) {
+            double p, q, s = fb / fa;
+            if (a == c) {
+                p = 2 * half * s;
+                q = 1 - s;
+            } else {
+                double r = fb / fc;
+                q = fa / fc;
+                p = s * (2 * half * q * (q - r) - (b - a) * (r - 1));
+                q = (q - 1) * (r - 1) * (s - 1);
+            }
+            if (p > 0) {
+                q = -q;
+            }
+            p = std::abs(p);
+            if (2 * p < std::min(3 * half * q - std::abs(limit * q), std::abs(e * q))) {
+                e = d;
+                d = p / q;
+            } else {
+                d = half;
+                e = d;
+            }
+        } else {
+            d = half;
+            e = d;
+        }
+
+        a = b;
+        fa = fb;
+        b += std::abs(d) > limit ? d : std::copysign(limit, half);
+        fb = value(b);
+        stats.evaluations++;
+    }
+    return b;
+}
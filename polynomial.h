@@ -0,0 +1,241 @@
+#ifndef POLYNOMIAL_H
+#define POLYNOMIAL_H
+
+#include <QVector>
+
+/**
+ * @brief Многочлен с действительными коэффициентами
+ *
+ * Коэффициенты хранятся начиная со старшей степени, ведущие нулевые
+ * коэффициенты отбрасываются. Значение вычисляется по схеме Горнера,
+ * действительные корни отделяются последовательностью Штурма
+ */
+class polynomial
+{
+public:
+    /**
+     * @brief Способ уточнения отделённого корня
+     */
+    enum class refinement {
+        BISECTION, ///< Деление отрезка пополам
+        ILLINOIS,  ///< Метод ложного положения с модификацией Illinois
+        BRENT,     ///< Метод Брента
+        NEWTON,    ///< Метод Ньютона с откатом к бисекции
+    };
+
+    /**
+     * @brief Затраты на поиск корней
+     */
+    struct statistics {
+        int iterations = 0;  ///< Итерации уточнения корней
+        int evaluations = 0; ///< Вычисления многочлена и его производной
+    };
+
+    /**
+     * @brief Корень с кратностью
+     */
+    struct root {
+        double value = 0;     ///< Значение корня
+        int multiplicity = 1; ///< Кратность корня
+    };
+
+    /**
+     * @brief Конструктор нулевого многочлена
+     */
+    polynomial() = default;
+
+    /**
+     * @brief Конструктор многочлена
+     * @param coefficients Коэффициенты, начиная со старшей степени
+     */
+    explicit polynomial(const QVector<double>& coefficients);
+
+    /**
+     * @brief Степень многочлена
+     * @return Степень (-1 для нулевого многочлена)
+     */
+    int degree() const;
+
+    /**
+     * @brief Коэффициенты многочлена
+     * @return Коэффициенты, начиная со старшей степени
+     */
+    const QVector<double>& coefficients() const;
+
+    /**
+     * @brief Значение многочлена по схеме Горнера
+     * @param x Значение переменной
+     * @return p(x)
+     */
+    double value(double x) const;
+
+    /**
+     * @brief Производная многочлена
+     * @return p'(x)
+     */
+    polynomial derivative() const;
+
+    /**
+     * @brief Граница модулей корней
+     * @return Число R, такое что все корни лежат в [-R, R]
+     *
+     * Берётся меньшая из оценок Коши и Фудзивары
+     */
+    double root_bound() const;
+
+    /**
+     * @brief Последовательность Штурма
+     * @return p, p', -rem(p, p'), ...
+     *
+     * Каждый член нормирован на наибольший по модулю коэффициент
+     */
+    QVector<polynomial> sturm_sequence() const;
+
+    /**
+     * @brief Число перемен знака последовательности Штурма в точке
+     * @param sequence Последовательность Штурма
+     * @param x Точка
+     * @return Число перемен знака (нули пропускаются)
+     */
+    static int sign_changes(const QVector<polynomial>& sequence, double x);
+
+    /**
+     * @brief Оценка ошибки округления при вычислении p(x)
+     * @param x Значение переменной
+     * @return Граница, ниже которой |p(x)| неотличимо от нуля
+     *
+     * Пропорциональна сумме |a_k|·|x|^k, поэтому не зависит от масштаба коэффициентов
+     */
+    double rounding_error(double x) const;
+
+    /**
+     * @brief Проверка достижения относительной точности
+     * @param left Левая граница отрезка
+     * @param right Правая граница отрезка
+     * @param tolerance Относительная точность
+     * @return true если отрезок достаточно узок
+     */
+    static bool converged(double left, double right, double tolerance);
+
+    /**
+     * @brief Уточнение корня на отрезке со сменой знака
+     * @param left Левая граница
+     * @param right Правая граница
+     * @param f_left Значение в left
+     * @param f_right Значение в right (знак противоположен f_left)
+     * @param method Способ уточнения
+     * @param tolerance Относительная точность
+     * @param stats Счётчики затрат (может быть nullptr)
+     * @return Корень
+     */
+    double solve_bracket(double left, double right, double f_left, double f_right,
+                         refinement method, double tolerance, statistics* stats = nullptr) const;
+
+    /**
+     * @brief Действительные корни многочлена
+     * @param method Способ уточнения корня после отделения
+     * @param tolerance Относительная точность корня
+     * @param stats Счётчики затрат (может быть nullptr)
+     * @return Различные действительные корни по возрастанию
+     *
+     * Число вычислений растёт с числом корней, а не с шириной отрезка поиска
+     */
+    QVector<double> real_roots(refinement method = refinement::NEWTON, double tolerance = 1e-12,
+                               statistics* stats = nullptr) const;
+
+    /**
+     * @brief Критические точки многочлена
+     * @param tolerance Относительная точность
+     * @param stats Счётчики затрат (может быть nullptr)
+     * @return Различные действительные корни p' по возрастанию
+     */
+    QVector<double> critical_points(double tolerance = 1e-12, statistics* stats = nullptr) const;
+
+    /**
+     * @brief Кратные корни
+     * @param tolerance Относительная точность
+     * @param stats Счётчики затрат (может быть nullptr)
+     * @return Критические точки, в которых |p| не превышает ошибки округления, с кратностью
+     *
+     * В таких корнях p не меняет знак, поэтому поиск смены знака их не находит.
+     * Кратность на единицу больше кратности того же корня у p'
+     */
+    QVector<root> tangent_roots(double tolerance = 1e-12, statistics* stats = nullptr) const;
+
+    /**
+     * @brief Действительные корни с кратностью
+     * @param method Способ уточнения корня после отделения
+     * @param tolerance Относительная точность
+     * @param stats Счётчики затрат (может быть nullptr)
+     * @return Различные действительные корни по возрастанию
+     */
+    QVector<root> roots(refinement method = refinement::NEWTON, double tolerance = 1e-12,
+                        statistics* stats = nullptr) const;
+
+    /**
+     * @brief Кратность корня по списку кратных корней
+     * @param tangents Результат tangent_roots
+     * @param x Корень
+     * @param tolerance Относительная точность
+     * @return Кратность совпадающего кратного корня или 1
+     *
+     * Корень кратности k определяется с точностью порядка tolerance^(1/k),
+     * поэтому совпадение проверяется с таким допуском
+     */
+    static int multiplicity(const QVector<root>& tangents, double x, double tolerance);
+
+private:
+    QVector<double> coeffs; ///< Коэффициенты, начиная со старшей степени
+
+    /**
+     * @brief Остаток от деления многочленов
+     * @param dividend Делимое
+     * @param divisor Делитель
+     * @return Остаток; коэффициенты на уровне ошибки округления отбрасываются
+     */
+    static polynomial remainder(const polynomial& dividend, const polynomial& divisor);
+
+    /**
+     * @brief Рекурсивное отделение корней
+     * @param sequence Последовательность Штурма
+     * @param left Левая граница
+     * @param right Правая граница
+     * @param changes_left Число перемен знака в left
+     * @param changes_right Число перемен знака в right
+     * @param method Способ уточнения корня
+     * @param tolerance Относительная точность
+     * @param stats Счётчики затрат
+     * @param roots Вектор найденных корней
+     */
+    void isolate(const QVector<polynomial>& sequence, double left, double right,
+                 int changes_left, int changes_right, refinement method, double tolerance,
+                 statistics& stats, QVector<double>& roots) const;
+
+    /**
+     * @brief Уточнение единственного корня на отрезке (left, right]
+     * @param sequence Последовательность Штурма
+     * @param left Левая граница
+     * @param right Правая граница
+     * @param method Способ уточнения корня
+     * @param tolerance Относительная точность
+     * @param stats Счётчики затрат
+     * @return Корень
+     */
+    double refine(const QVector<polynomial>& sequence, double left, double right,
+                  refinement method, double tolerance, statistics& stats) const;
+
+    /**
+     * @brief Метод Брента на отрезке со сменой знака
+     * @param left Левая граница
+     * @param right Правая граница
+     * @param f_left Значение в left
+     * @param f_right Значение в right
+     * @param tolerance Относительная точность
+     * @param stats Счётчики затрат
+     * @return Корень
+     */
+    double brent(double left, double right, double f_left, double f_right,
+                 double tolerance, statistics& stats) const;
+};
+
+#endif // POLYNOMIAL_H
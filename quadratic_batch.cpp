@@ -0,0 +1,298 @@
+#include "../include/quadratic_batch.h"
+#include "../include/grid_kernel.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QString>
+#include <QtEndian>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define QUADRATIC_BATCH_X86
+#include <immintrin.h>
+#endif
+
+/// Префикс ответа на пакет
+static const QByteArray reply_prefix("answer|batch|");
+
+/**
+ * @brief Читает массив double в порядке little-endian
+ * @param source Исходные байты
+ * @param count Количество чисел
+ * @param target Массив результата
+ */
+static void read_doubles(const char* source, int count, double* target) {
+    std::memcpy(target, source, size_t(count) * sizeof(double));
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    for (int i = 0; i < count; i++) {
+        quint64 bits;
+        std::memcpy(&bits, target + i, sizeof(bits));
+        bits = qFromLittleEndian(bits);
+        std::memcpy(target + i, &bits, sizeof(bits));
+    }
+#endif
+}
+
+/**
+ * @brief Дописывает массив double в порядке little-endian
+ * @param target Массив байтов
+ * @param source Числа
+ * @param count Количество чисел
+ */
+static void write_doubles(QByteArray& target, const double* source, int count) {
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    for (int i = 0; i < count; i++) {
+        quint64 bits;
+        std::memcpy(&bits, source + i, sizeof(bits));
+        bits = qToLittleEndian(bits);
+        target.append(reinterpret_cast<const char*>(&bits), sizeof(bits));
+    }
+#else
+    target.append(reinterpret_cast<const char*>(source), int(size_t(count) * sizeof(double)));
+#endif
+}
+
+/**
+ * @brief Скалярное решение массива уравнений
+ *
+ * Повторяет ветви functions_for_server::analytic_quadratic
+ */
+static void solve_scalar(const double* a, const double* b, const double* c, int count,
+                         quint8* roots, double* x1, double* x2) {
+    const double rounding_factor = 4 * std::numeric_limits<double>::epsilon();
+    for (int i = 0; i < count; i++) {
+        x1[i] = x2[i] = 0;
+        if (qFuzzyIsNull(a[i])) {
+            if (!qFuzzyIsNull(b[i])) {
+                roots[i] = 1;
+                x1[i] = x2[i] = -c[i] / b[i] + 0.0;
+            } else {
+                roots[i] = qFuzzyIsNull(c[i]) ? quadratic_batch::infinite_roots : 0;
+            }
+            continue;
+        }
+
+        const double square = b[i] * b[i];
+        const double product = 4 * a[i] * c[i];
+        const double discriminant = square - product;
+        if (std::abs(discriminant) <= rounding_factor * std::max(square, std::abs(product))) {
+            roots[i] = 1;
+            x1[i] = x2[i] = -b[i] / (2 * a[i]) + 0.0;
+        } else if (discriminant < 0) {
+            roots[i] = 0;
+        } else {
+            const double q = -0.5 * (b[i] + std::copysign(std::sqrt(discriminant), b[i]));
+            const double first = q / a[i] + 0.0;
+            const double second = c[i] / q + 0.0;
+            roots[i] = 2;
+            x1[i] = std::min(first, second);
+            x2[i] = std::max(first, second);
+        }
+    }
+}
+
+#ifdef QUADRATIC_BATCH_X86
+/**
+ * @brief Решение массива уравнений, 4 уравнения за инструкцию
+ *
+ * Все ветви вычисляются для всех уравнений, нужный результат
+ * выбирается масками сравнений
+ */
+__attribute__((target("avx2")))
+static void solve_avx2(const double* a, const double* b, const double* c, int count,
+                       quint8* roots, double* x1, double* x2) {
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d fuzzy = _mm256_set1_pd(0.000000000001); // порог qFuzzyIsNull
+    const __m256d two = _mm256_set1_pd(2);
+    const __m256d four = _mm256_set1_pd(4);
+    const __m256d minus_half = _mm256_set1_pd(-0.5);
+    const __m256d rounding_factor = _mm256_set1_pd(4 * std::numeric_limits<double>::epsilon());
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m256d va = _mm256_loadu_pd(a + i);
+        const __m256d vb = _mm256_loadu_pd(b + i);
+        const __m256d vc = _mm256_loadu_pd(c + i);
+
+        const __m256d null_a = _mm256_cmp_pd(_mm256_andnot_pd(sign, va), fuzzy, _CMP_LE_OQ);
+        const __m256d null_b = _mm256_cmp_pd(_mm256_andnot_pd(sign, vb), fuzzy, _CMP_LE_OQ);
+        const __m256d null_c = _mm256_cmp_pd(_mm256_andnot_pd(sign, vc), fuzzy, _CMP_LE_OQ);
+
+        const __m256d square = _mm256_mul_pd(vb, vb);
+        const __m256d product = _mm256_mul_pd(_mm256_mul_pd(four, va), vc);
+        const __m256d discriminant = _mm256_sub_pd(square, product);
+        const __m256d rounding = _mm256_mul_pd(rounding_factor,
+                                               _mm256_max_pd(square, _mm256_andnot_pd(sign, product)));
+        const __m256d is_double = _mm256_cmp_pd(_mm256_andnot_pd(sign, discriminant), rounding, _CMP_LE_OQ);
+        const __m256d is_negative = _mm256_cmp_pd(discriminant, zero, _CMP_LT_OQ);
+
+        // q = -(b + sign(b)·√D) / 2, x1 = q / a, x2 = c / q
+        const __m256d root = _mm256_sqrt_pd(_mm256_max_pd(discriminant, zero));
+        const __m256d signed_root = _mm256_or_pd(_mm256_andnot_pd(sign, root), _mm256_and_pd(sign, vb));
+        const __m256d q = _mm256_mul_pd(minus_half, _mm256_add_pd(vb, signed_root));
+        const __m256d first = _mm256_add_pd(_mm256_div_pd(q, va), zero);
+        const __m256d second = _mm256_add_pd(_mm256_div_pd(vc, q), zero);
+        __m256d low = _mm256_min_pd(first, second);
+        __m256d high = _mm256_max_pd(first, second);
+
+        const __m256d vertex = _mm256_add_pd(_mm256_div_pd(_mm256_xor_pd(vb, sign), _mm256_mul_pd(two, va)), zero);
+        low = _mm256_blendv_pd(low, vertex, is_double);
+        high = _mm256_blendv_pd(high, vertex, is_double);
+
+        const __m256d linear = _mm256_add_pd(_mm256_div_pd(_mm256_xor_pd(vc, sign), vb), zero);
+        low = _mm256_blendv_pd(low, linear, null_a);
+        high = _mm256_blendv_pd(high, linear, null_a);
+
+        const __m256d quadratic_none = _mm256_andnot_pd(is_double, is_negative);
+        const __m256d none = _mm256_or_pd(_mm256_andnot_pd(null_a, quadratic_none), _mm256_and_pd(null_a, null_b));
+        _mm256_storeu_pd(x1 + i, _mm256_andnot_pd(none, low));
+        _mm256_storeu_pd(x2 + i, _mm256_andnot_pd(none, high));
+
+        const int mask_a = _mm256_movemask_pd(null_a);
+        const int mask_b = _mm256_movemask_pd(null_b);
+        const int mask_c = _mm256_movemask_pd(null_c);
+        const int mask_double = _mm256_movemask_pd(is_double);
+        const int mask_negative = _mm256_movemask_pd(is_negative);
+        for (int lane = 0; lane < 4; lane++) {
+            const int bit = 1 << lane;
+            quint8 result;
+            if (mask_a & bit) {
+                result = !(mask_b & bit) ? 1 : (mask_c & bit) ? quadratic_batch::infinite_roots : 0;
+            } else {
+                result = (mask_double & bit) ? 1 : (mask_negative & bit) ? 0 : 2;
+            }
+            roots[i + lane] = result;
+        }
+    }
+    solve_scalar(a + i, b + i, c + i, count - i, roots + i, x1 + i, x2 + i);
+}
+#endif
+
+/**
+ * @brief Разбирает нагрузку сообщения
+ * @param payload Байты после "equation|batch|"
+ * @return true если нагрузка корректна
+ */
+bool quadratic_batch::unpack(const QByteArray& payload) {
+    if (payload.size() < int(sizeof(quint32))) {
+        return false;
+    }
+    const quint32 count = qFromLittleEndian<quint32>(payload.constData());
+    if (count > quint32(max_count)
+        || qint64(payload.size()) != qint64(sizeof(quint32)) + 3 * qint64(count) * qint64(sizeof(double))) {
+        return false;
+    }
+
+    const int n = int(count);
+    a.resize(n);
+    b.resize(n);
+    c.resize(n);
+    const char* data = payload.constData() + sizeof(quint32);
+    read_doubles(data, n, a.data());
+    read_doubles(data + n * sizeof(double), n, b.data());
+    read_doubles(data + 2 * n * sizeof(double), n, c.data());
+    return true;
+}
+
+/**
+ * @brief Решает все уравнения пакета
+ */
+void quadratic_batch::solve() {
+    const int n = size();
+    roots.resize(n);
+    x1.resize(n);
+    x2.resize(n);
+    solve(a.constData(), b.constData(), c.constData(), n, roots.data(), x1.data(), x2.data());
+}
+
+/**
+ * @brief Упаковывает ответ
+ * @return Сообщение с результатами
+ */
+QByteArray quadratic_batch::pack() const {
+    const int n = size();
+    QByteArray message;
+    message.reserve(reply_prefix.size() + int(sizeof(quint32)) + n * int(1 + 2 * sizeof(double)));
+    message.append(reply_prefix);
+
+    char header[sizeof(quint32)];
+    qToLittleEndian<quint32>(quint32(n), header);
+    message.append(header, sizeof(header));
+    message.append(reinterpret_cast<const char*>(roots.constData()), n);
+    write_doubles(message, x1.constData(), n);
+    write_doubles(message, x2.constData(), n);
+    return message;
+}
+
+/**
+ * @brief Возвращает количество уравнений
+ * @return Размер пакета
+ */
+int quadratic_batch::size() const {
+    return a.size();
+}
+
+/**
+ * @brief Решает массив уравнений лучшим доступным ядром
+ * @param a Коэффициенты a
+ * @param b Коэффициенты b
+ * @param c Коэффициенты c
+ * @param count Количество уравнений
+ * @param roots Число корней
+ * @param x1 Меньшие корни
+ * @param x2 Большие корни
+ */
+void quadratic_batch::solve(const double* a, const double* b, const double* c, int count,
+                            quint8* roots, double* x1, double* x2) {
+#ifdef QUADRATIC_BATCH_X86
+    static const bool vectorized = grid_kernel::selected() == grid_kernel::instruction_set::AVX2;
+    if (vectorized) {
+        solve_avx2(a, b, c, count, roots, x1, x2);
+        return;
+    }
+#endif
+    solve_scalar(a, b, c, count, roots, x1, x2);
+}
+
+/**
+ * @brief Микротест производительности
+ *
+ * Решает 2^16 уравнений с коэффициентами из [-10, 10] 64 раза
+ * каждым доступным ядром
+ */
+void quadratic_batch::benchmark() {
+    const int count = 1 << 16;
+    const int rounds = 64;
+    QVector<double> a(count), b(count), c(count), x1(count), x2(count);
+    QVector<quint8> roots(count);
+    quint64 seed = 1;
+    for (int i = 0; i < count; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        a[i] = double(seed >> 44) / double(1 << 20) * 20 - 10;
+        b[i] = double((seed >> 24) & 0xFFFFF) / double(1 << 20) * 20 - 10;
+        c[i] = double((seed >> 4) & 0xFFFFF) / double(1 << 20) * 20 - 10;
+    }
+
+    auto measure = [&](const QString& name, void (*kernel)(const double*, const double*, const double*, int,
+                                                           quint8*, double*, double*)) {
+        QElapsedTimer timer;
+        timer.start();
+        for (int round = 0; round < rounds; round++) {
+            kernel(a.constData(), b.constData(), c.constData(), count, roots.data(), x1.data(), x2.data());
+        }
+        double seconds = qMax<qint64>(1, timer.nsecsElapsed()) / 1e9;
+        qDebug() << QString("quadratic_batch %1: %2 млн уравнений/с")
+                        .arg(name)
+                        .arg(double(count) * rounds / seconds / 1e6, 0, 'f', 1);
+    };
+
+    measure("scalar", solve_scalar);
+#ifdef QUADRATIC_BATCH_X86
+    if (grid_kernel::selected() == grid_kernel::instruction_set::AVX2) {
+        measure("AVX2", solve_avx2);
+    }
+#endif
+}
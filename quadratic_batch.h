@@ -0,0 +1,80 @@
+#ifndef QUADRATIC_BATCH_H
+#define QUADRATIC_BATCH_H
+
+#include <QByteArray>
+#include <QVector>
+
+/**
+ * @brief Пакет квадратных уравнений, решаемых за одно сообщение
+ *
+ * Коэффициенты хранятся структурой массивов (a[], b[], c[]), поэтому
+ * дискриминанты и корни вычисляются векторизованными циклами по 4 уравнения
+ * за инструкцию AVX2. Результаты совпадают с functions_for_server::analytic_quadratic.
+ *
+ * Формат нагрузки после "equation|batch|" (только протокол v2, числа little-endian):
+ * n (uint32), a[n], b[n], c[n] (double).
+ * Формат ответа после "answer|batch|": n (uint32), roots[n] (uint8),
+ * x1[n], x2[n] (double). roots - число корней: 0, 1 (x1 = x2), 2 (x1 < x2)
+ * или infinite_roots
+ */
+class quadratic_batch
+{
+public:
+    static const quint8 infinite_roots = 255; ///< Любое x является корнем
+    static const int max_count = 1 << 19;     ///< Наибольшее число уравнений в пакете
+
+    /**
+     * @brief Разбор нагрузки сообщения
+     * @param payload Байты после "equation|batch|"
+     * @return true если размер нагрузки соответствует числу уравнений
+     */
+    bool unpack(const QByteArray& payload);
+
+    /**
+     * @brief Решение всех уравнений пакета
+     */
+    void solve();
+
+    /**
+     * @brief Упаковка ответа
+     * @return Сообщение "answer|batch|" с результатами
+     */
+    QByteArray pack() const;
+
+    /**
+     * @brief Количество уравнений
+     * @return Размер пакета
+     */
+    int size() const;
+
+    /**
+     * @brief Векторизованное решение массива уравнений
+     * @param a Коэффициенты a
+     * @param b Коэффициенты b
+     * @param c Коэффициенты c
+     * @param count Количество уравнений
+     * @param roots Число корней каждого уравнения
+     * @param x1 Меньший корень
+     * @param x2 Больший корень
+     */
+    static void solve(const double* a, const double* b, const double* c, int count,
+                      quint8* roots, double* x1, double* x2);
+
+    /**
+     * @brief Микротест производительности
+     *
+     * Выводит в журнал число решённых уравнений в секунду
+     * для скалярного и векторизованного ядра
+     */
+    static void benchmark();
+
+private:
+    QVector<double> a;      ///< Коэффициенты a
+    QVector<double> b;      ///< Коэффициенты b
+    QVector<double> c;      ///< Коэффициенты c
+    QVector<quint8> roots;  ///< Число корней
+    QVector<double> x1;     ///< Меньшие корни
+    QVector<double> x2;     ///< Большие корни
+};
+
+#endif // QUADRATIC_BATCH_H
@@ -0,0 +1,22 @@
+#ifndef REQUEST_CONTEXT_H
+#define REQUEST_CONTEXT_H
+
+#include <QMetaType>
+#include "frame_buffer.h"
+
+/**
+ * @brief Контекст запроса клиента
+ *
+ * Передаётся вместе с каждой задачей (решение уравнения, авторизация,
+ * регистрация, сброс пароля), чтобы ответ был доставлен только
+ * в соединение, из которого пришёл запрос
+ */
+struct request_context
+{
+    quint64 connection_id = 0;                       ///< Идентификатор соединения-отправителя
+    protocol_mode protocol = protocol_mode::UNKNOWN; ///< Согласованная версия протокола соединения
+};
+
+Q_DECLARE_METATYPE(request_context)
+
+#endif // REQUEST_CONTEXT_H
@@ -0,0 +1,172 @@
+#include "../include/request_dispatcher.h"
+#include "../include/message_tokenizer.h"
+#include "../include/functions_for_server.h"
+#include "../include/dbsingleton.h"
+#include "../include/connection_registry.h"
+#include <QDebug>
+#include <QLoggingCategory>
+
+extern functions_for_server* servers_functions; ///< Глобальный экземпляр функций сервера
+
+/// Журнал принятых сообщений; по умолчанию выключен, так как строка журнала
+/// требует нескольких выделений памяти на каждое сообщение. Включается
+/// переменной окружения QT_LOGGING_RULES="server.dispatcher.debug=true"
+Q_LOGGING_CATEGORY(dispatcher_log, "server.dispatcher", QtInfoMsg)
+
+/**
+ * @brief Конструктор диспетчера
+ * @param parent Родительский объект
+ *
+ * Устанавливает signal-slot соединения для:
+ * - Регистрации
+ * - Авторизации
+ * - Сброса пароля
+ * - Решения уравнений
+ */
+request_dispatcher::request_dispatcher(QObject* parent): QObject(parent)
+{
+    // Запросы к базе выполняются в потоке соединения на соединении из пула DBSingleton
+
+    // Соединения для регистрации
+    connect(this, &request_dispatcher::signal_register_new_account,
+            DBSingleton::getInstance(), &DBSingleton::slot_register_new_account, Qt::DirectConnection);
+
+    // Соединения для авторизации
+    connect(this, &request_dispatcher::signal_auth,
+            DBSingleton::getInstance(), &DBSingleton::slot_auth, Qt::DirectConnection);
+
+    // Соединения для сброса пароля
+    connect(this, &request_dispatcher::signal_send_code_to_email,
+            DBSingleton::getInstance(), &DBSingleton::slot_send_code, Qt::DirectConnection);
+    connect(this, &request_dispatcher::signal_set_new_password,
+            DBSingleton::getInstance(), &DBSingleton::slot_new_password, Qt::DirectConnection);
+
+    // Соединения для решения уравнений: слот выполняется в потоке соединения
+    // и передаёт задачу в пул потоков решателя
+    connect(this, &request_dispatcher::signal_linear_equation,
+            servers_functions, &functions_for_server::slot_linear_equation, Qt::DirectConnection);
+    connect(this, &request_dispatcher::signal_quadratic_equation,
+            servers_functions, &functions_for_server::slot_quadratic_equation, Qt::DirectConnection);
+    connect(this, &request_dispatcher::signal_polynomial_equation,
+            servers_functions, &functions_for_server::slot_polynomial_equation, Qt::DirectConnection);
+    connect(this, &request_dispatcher::signal_batch_equation,
+            servers_functions, &functions_for_server::slot_batch_equation, Qt::DirectConnection);
+}
+
+/**
+ * @brief Разбирает коэффициенты уравнения
+ * @param text Поле коэффициентов через '$'
+ * @param count Число используемых коэффициентов
+ * @param values Результат (пустой, если коэффициентов меньше count или
+ *        коэффициент не является числом)
+ */
+static void parse_coefficients(QByteArrayView text, int count, QVector<double>& values) {
+    QByteArrayView parts[3];
+    if (message_tokenizer::split(text, '$', parts, 3) < count) {
+        return;
+    }
+    values.reserve(count);
+    for (int i = 0; i < count; i++) {
+        double value;
+        if (!message_tokenizer::to_double(parts[i], value)) {
+            values.clear();
+            break;
+        }
+        values.push_back(value);
+    }
+}
+
+/**
+ * @brief Разбор сообщения клиента
+ * @param context Контекст запроса
+ * @param message Сообщение в формате "action|payload"
+ *
+ * Обрабатывает различные действия клиента:
+ * - Пакет квадратных уравнений ("equation|batch|", только протокол v2)
+ * - Регистрация ("reg")
+ * - Авторизация ("login")
+ * - Сброс пароля ("reset", "new_password")
+ * - Решение уравнений ("equation")
+ *
+ * Сообщение разбирается message_tokenizer прямо в принятых байтах UTF-8.
+ * Коэффициенты уравнений разбираются здесь же, строки QString создаются
+ * только для полей, которые передаются в обработчики
+ */
+void request_dispatcher::dispatch(const request_context& context, const QByteArray& message) {
+    static const QByteArray batch_prefix("equation|batch|");
+    if (message.startsWith(batch_prefix)) {
+        // Без кадров двоичная нагрузка приходит частями, и каждая часть
+        // разбиралась бы как отдельный пакет
+        if (context.protocol != protocol_mode::FRAMED) {
+            connection_registry::reply(context, QString("answer|Пакет уравнений доступен только в протоколе v2").toUtf8());
+            return;
+        }
+        emit signal_batch_equation(context, message.mid(batch_prefix.size()));
+        return;
+    }
+
+    const message_tokenizer tokens(message);
+    if (tokens.size() < 2) {
+        qDebug() << QString("%1 Клиент ").arg(servers_functions->get_server_time())
+                 << context.connection_id
+                 << QString(" отправил некорректное сообщение: %1").arg(QString::fromUtf8(message)).simplified();
+        return;
+    }
+
+    const QByteArrayView action = tokens.field(0);
+    QByteArrayView fields[6];
+    const int field_count = message_tokenizer::split(tokens.field(1), '$', fields, 6);
+
+    // Обработка регистрации
+    if (action == "reg" && field_count >= 6) {
+        emit signal_register_new_account(
+            context,
+            QString::fromUtf8(fields[0]), // логин
+            QString::fromUtf8(fields[1]), // пароль
+            QString::fromUtf8(fields[2]), // email
+            QString::fromUtf8(fields[3]), // фамилия
+            QString::fromUtf8(fields[4]), // имя
+            QString::fromUtf8(fields[5])  // отчество
+            );
+    }
+
+    // Обработка авторизации
+    if (action == "login" && field_count >= 2) {
+        emit signal_auth(context, QString::fromUtf8(fields[0]), QString::fromUtf8(fields[1]));
+    }
+
+    // Обработка сброса пароля
+    if (action == "reset" && field_count >= 2) {
+        emit signal_send_code_to_email(context, QString::fromUtf8(fields[0]), QString::fromUtf8(fields[1]));
+    }
+    if (action == "new_password" && field_count >= 2) {
+        emit signal_set_new_password(context, QString::fromUtf8(fields[0]), QString::fromUtf8(fields[1]));
+    }
+
+    // Обработка решения уравнений
+    if (action == "equation" && tokens.size() >= 3) {
+        const QByteArrayView type_equation = tokens.field(1);
+        const QString options = tokens.size() >= 4 ? QString::fromUtf8(tokens.field(3)) : QString();
+        QVector<double> coefficients;
+        // Некорректные коэффициенты тоже передаются решателю: он отвечает ошибкой
+        if (type_equation == "linear") {
+            parse_coefficients(tokens.field(2), 2, coefficients);
+            emit signal_linear_equation(context, coefficients, options);
+        }
+        if (type_equation == "quadratic") {
+            parse_coefficients(tokens.field(2), 3, coefficients);
+            emit signal_quadratic_equation(context, coefficients, options);
+        }
+        if (type_equation == "polynomial") {
+            if (!message_tokenizer::to_doubles(tokens.field(2), '$', coefficients)) {
+                coefficients.clear();
+            }
+            emit signal_polynomial_equation(context, coefficients, options);
+        }
+    }
+
+    // Аргументы вычисляются, только если категория включена
+    qCDebug(dispatcher_log) << QString("%1 Клиент ").arg(servers_functions->get_server_time())
+                            << context.connection_id
+                            << QString(" отправил сообщение: %1").arg(QString::fromUtf8(message)).simplified();
+}
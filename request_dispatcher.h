@@ -0,0 +1,123 @@
+#ifndef REQUEST_DISPATCHER_H
+#define REQUEST_DISPATCHER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include <QVector>
+#include "request_context.h"
+
+/**
+ * @brief Разбор сообщений клиентов и передача их обработчикам
+ *
+ * Общий для всех сетевых подсистем: соединение передаёт сюда каждое
+ * принятое сообщение вместе с контекстом запроса, а ответ обработчика
+ * возвращается через connection_registry::reply. Все сигналы обрабатываются
+ * в потоке соединения: решатель сам ставит задачу в пул, а DBSingleton
+ * выполняет запрос на соединении этого потока из пула соединений
+ */
+class request_dispatcher: public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Конструктор
+     * @param parent Родительский объект
+     *
+     * Подключает сигналы к обработчикам functions_for_server и DBSingleton
+     */
+    explicit request_dispatcher(QObject* parent = nullptr);
+
+    /**
+     * @brief Разбор одного сообщения и передача его обработчику
+     * @param context Контекст запроса
+     * @param message Сообщение в формате "action|payload" (UTF-8)
+     *
+     * Сообщение "equation|batch|" содержит двоичные данные и передаётся
+     * решателю без разбора; вне протокола v2 на него отвечает ошибкой
+     */
+    void dispatch(const request_context& context, const QByteArray& message);
+
+signals:
+    /// @name Сигналы для регистрации
+    /// @{
+    /**
+    * @brief Сигнал регистрации нового аккаунта
+    * @param context Контекст запроса
+    * @param login Логин
+    * @param password Пароль
+    * @param email Email
+    * @param last_name Фамилия
+    * @param first_name Имя
+    * @param middle_name Отчество
+    */
+    void signal_register_new_account(request_context context, QString login, QString password, QString email, QString last_name, QString first_name, QString middle_name);
+    /// @}
+
+    /// @name Сигналы для авторизации
+    /// @{
+    /**
+    * @brief Сигнал авторизации
+    * @param context Контекст запроса
+    * @param login Логин
+    * @param password Пароль
+    */
+    void signal_auth(request_context context, QString login, QString password);
+    /// @}
+
+    /// @name Сброс пароля
+    /// @{
+    /**
+    * @brief Сигнал отправки кода на email клиента
+    * @param context Контекст запроса
+    * @param email Email клиента
+    * @param code Код подтверждения
+    */
+    void signal_send_code_to_email(request_context context, QString email, QString code);
+
+    /**
+    * @brief Сигнал установки нового пароля
+    * @param context Контекст запроса
+    * @param email Email клиента
+    * @param password Новый пароль
+    */
+    void signal_set_new_password(request_context context, QString email, QString password);
+    /// @}
+
+    /// @name Главное клиентское окно
+    /// @{
+    /**
+    * @brief Сигнал решения линейного уравнения
+    * @param context Контекст запроса
+    * @param coefficients Коэффициенты a, b (пустой вектор, если ввод некорректен)
+    * @param options Параметры решения (необязательное поле сообщения)
+    */
+    void signal_linear_equation(request_context context, QVector<double> coefficients, QString options);
+
+    /**
+    * @brief Сигнал решения квадратного уравнения
+    * @param context Контекст запроса
+    * @param coefficients Коэффициенты a, b, c (пустой вектор, если ввод некорректен)
+    * @param options Параметры решения (необязательное поле сообщения)
+    */
+    void signal_quadratic_equation(request_context context, QVector<double> coefficients, QString options);
+
+    /**
+    * @brief Сигнал решения уравнения с многочленом произвольной степени
+    * @param context Контекст запроса
+    * @param coefficients Коэффициенты, начиная со старшей степени (пустой вектор, если ввод некорректен)
+    * @param options Параметры решения (необязательное поле сообщения)
+    */
+    void signal_polynomial_equation(request_context context, QVector<double> coefficients, QString options);
+
+    /**
+    * @brief Сигнал решения пакета квадратных уравнений
+    * @param context Контекст запроса
+    * @param payload Двоичная нагрузка после "equation|batch|" (см. quadratic_batch)
+    */
+    void signal_batch_equation(request_context context, QByteArray payload);
+    /// @}
+};
+
+#endif // REQUEST_DISPATCHER_H
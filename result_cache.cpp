@@ -0,0 +1,122 @@
+#include "../include/result_cache.h"
+
+/// Накладные расходы на запись: узел списка, узел хеш-таблицы и заголовки QByteArray
+static const qint64 entry_overhead = 128;
+
+/**
+ * @brief Конструктор кэша
+ * @param budget Бюджет памяти в байтах
+ * @param shard_count Количество сегментов
+ */
+result_cache::result_cache(qint64 budget, int shard_count)
+    : total_budget(qMax<qint64>(0, budget)) {
+    shard_count = qMax(1, shard_count);
+    shard_budget = total_budget / shard_count;
+    for (int i = 0; i < shard_count; i++) {
+        shards.push_back(std::make_unique<shard>());
+    }
+}
+
+/**
+ * @brief Вычисляет объём записи
+ * @param key Ключ
+ * @param value Ответ
+ * @return Размер в байтах
+ */
+qint64 result_cache::cost(const QByteArray& key, const QByteArray& value) {
+    return key.size() + value.size() + entry_overhead;
+}
+
+/**
+ * @brief Возвращает сегмент для ключа
+ * @param key Ключ
+ * @return Сегмент
+ */
+result_cache::shard& result_cache::shard_for(const QByteArray& key) {
+    return *shards[qHash(key) % uint(shards.size())];
+}
+
+/**
+ * @brief Ищет ответ в кэше
+ * @param key Ключ
+ * @param value Найденный ответ
+ * @return true если ответ найден
+ */
+bool result_cache::find(const QByteArray& key, QByteArray& value) {
+    shard& target = shard_for(key);
+    QMutexLocker locker(&target.mutex);
+
+    auto found = target.index.constFind(key);
+    if (found == target.index.constEnd()) {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Перенос записи в начало списка не перемещает её в памяти
+    target.order.splice(target.order.begin(), target.order, found.value());
+    value = found.value()->value;
+    hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @brief Добавляет ответ в кэш
+ * @param key Ключ
+ * @param value Ответ
+ *
+ * После добавления с конца списка вытесняются записи, пока объём
+ * сегмента не станет меньше его бюджета
+ */
+void result_cache::insert(const QByteArray& key, const QByteArray& value) {
+    const qint64 size = cost(key, value);
+    if (size > shard_budget) {
+        return;
+    }
+
+    shard& target = shard_for(key);
+    QMutexLocker locker(&target.mutex);
+
+    auto found = target.index.find(key);
+    if (found != target.index.end()) {
+        target.bytes -= cost(key, found.value()->value);
+        target.order.erase(found.value());
+        target.index.erase(found);
+    }
+
+    target.order.push_front({key, value});
+    target.index.insert(key, target.order.begin());
+    target.bytes += size;
+
+    while (target.bytes > shard_budget) {
+        entry& oldest = target.order.back();
+        target.bytes -= cost(oldest.key, oldest.value);
+        target.index.remove(oldest.key);
+        target.order.pop_back();
+        evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Возвращает бюджет памяти
+ * @return Бюджет в байтах
+ */
+qint64 result_cache::budget() const {
+    return total_budget;
+}
+
+/**
+ * @brief Возвращает счётчики работы кэша
+ * @return Снимок счётчиков
+ */
+result_cache::counters result_cache::statistics() const {
+    counters result;
+    result.hits = hits.load(std::memory_order_relaxed);
+    result.misses = misses.load(std::memory_order_relaxed);
+    result.evictions = evictions.load(std::memory_order_relaxed);
+    for (const auto& current : shards) {
+        QMutexLocker locker(&current->mutex);
+        result.entries += current->index.size();
+        result.bytes += current->bytes;
+    }
+    return result;
+}
@@ -0,0 +1,118 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Кэш готовых ответов решателя с вытеснением давно не использованных (LRU)
+ *
+ * Ключи распределяются по сегментам (shards) по хешу, у каждого сегмента
+ * свой мьютекс, список порядка использования и доля общего бюджета памяти,
+ * поэтому потоки ввода-вывода и потоки решателя почти не конкурируют за
+ * блокировку. Размер записи считается как длина ключа и ответа плюс
+ * накладные расходы на узлы списка и хеш-таблицы
+ */
+class result_cache
+{
+public:
+    /**
+     * @brief Счётчики работы кэша
+     */
+    struct counters {
+        quint64 hits = 0;      ///< Ответы, найденные в кэше
+        quint64 misses = 0;    ///< Ответы, которых не было в кэше
+        quint64 evictions = 0; ///< Записи, вытесненные по бюджету
+        qint64 entries = 0;    ///< Текущее число записей
+        qint64 bytes = 0;      ///< Текущий объём записей
+    };
+
+    /**
+     * @brief Конструктор кэша
+     * @param budget Бюджет памяти в байтах
+     * @param shard_count Количество сегментов
+     */
+    explicit result_cache(qint64 budget, int shard_count = 16);
+
+    /**
+     * @brief Поиск ответа
+     * @param key Ключ
+     * @param value Найденный ответ
+     * @return true если ответ найден; запись становится самой свежей
+     */
+    bool find(const QByteArray& key, QByteArray& value);
+
+    /**
+     * @brief Добавление или обновление ответа
+     * @param key Ключ
+     * @param value Ответ
+     *
+     * Записи, не помещающиеся в бюджет сегмента, не сохраняются
+     */
+    void insert(const QByteArray& key, const QByteArray& value);
+
+    /**
+     * @brief Бюджет памяти
+     * @return Бюджет в байтах
+     */
+    qint64 budget() const;
+
+    /**
+     * @brief Счётчики работы кэша
+     * @return Снимок счётчиков
+     */
+    counters statistics() const;
+
+private:
+    /**
+     * @brief Запись кэша
+     */
+    struct entry {
+        QByteArray key;   ///< Ключ
+        QByteArray value; ///< Ответ
+    };
+
+    using entry_list = std::list<entry>; ///< Записи от самой свежей к самой старой
+
+    /**
+     * @brief Сегмент кэша
+     */
+    struct shard {
+        mutable QMutex mutex;                            ///< Защита сегмента
+        entry_list order;                                ///< Порядок использования
+        QHash<QByteArray, entry_list::iterator> index;   ///< Поиск записи по ключу
+        qint64 bytes = 0;                                ///< Объём записей сегмента
+    };
+
+    std::vector<std::unique_ptr<shard>> shards; ///< Сегменты
+    qint64 total_budget;                        ///< Общий бюджет памяти
+    qint64 shard_budget;                        ///< Бюджет одного сегмента
+    std::atomic<quint64> hits{0};               ///< Попадания
+    std::atomic<quint64> misses{0};             ///< Промахи
+    std::atomic<quint64> evictions{0};          ///< Вытеснения
+
+    /**
+     * @brief Сегмент, в котором хранится ключ
+     * @param key Ключ
+     * @return Сегмент
+     */
+    shard& shard_for(const QByteArray& key);
+
+    /**
+     * @brief Объём записи
+     * @param key Ключ
+     * @param value Ответ
+     * @return Размер в байтах
+     */
+    static qint64 cost(const QByteArray& key, const QByteArray& value);
+
+    result_cache(const result_cache&) = delete;            ///< Запрет копирования
+    result_cache& operator=(const result_cache&) = delete; ///< Запрет присваивания
+};
+
+#endif // RESULT_CACHE_H
@@ -0,0 +1,37 @@
+#include "../include/worker_listener.h"
+#include "../include/mytcpserver.h"
+#include "../include/client_object.h"
+#include "../include/frame_buffer.h"
+#include <QTcpSocket>
+
+/**
+ * @brief Конструктор слушателя
+ * @param server Сервер
+ * @param timeouts Тайм-ауты подключений
+ * @param parent Родительский объект
+ */
+worker_listener::worker_listener(MyTcpServer* server, const connection_timeouts& timeouts, QObject* parent)
+    : QTcpServer(parent), server(server), timeouts(timeouts) {
+}
+
+/**
+ * @brief Создание клиента в потоке слушателя
+ * @param descriptor Дескриптор сокета клиента
+ */
+void worker_listener::incomingConnection(qintptr descriptor) {
+    if (!server->admit_connection()) {
+        QTcpSocket* rejected = new QTcpSocket(this);
+        rejected->setSocketDescriptor(descriptor);
+        connect(rejected, &QTcpSocket::disconnected, rejected, &QObject::deleteLater);
+        rejected->write(frame_buffer::busy);
+        rejected->disconnectFromHost();
+        return;
+    }
+
+    // Клиент создаётся в текущем потоке и остаётся в нём до закрытия
+    client* client_object = new client(descriptor, timeouts);
+    MyTcpServer* owner = server;
+    connect(client_object, &QObject::destroyed, this, [owner]() {
+        owner->release_connection();
+    }, Qt::DirectConnection);
+}
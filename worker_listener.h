@@ -0,0 +1,45 @@
+#ifndef WORKER_LISTENER_H
+#define WORKER_LISTENER_H
+
+#include <QTcpServer>
+#include "connection_registry.h"
+
+class MyTcpServer;
+
+/**
+ * @brief Приём подключений в потоке ввода-вывода
+ *
+ * Каждый поток worker_pool получает собственный прослушивающий сокет
+ * с SO_REUSEPORT (см. listen_socket). Объект живёт в потоке пула и создаёт
+ * клиентов прямо в нём, без передачи подключения из главного потока
+ * и без moveToThread
+ */
+class worker_listener : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Конструктор
+     * @param server Сервер, ведущий учёт подключений
+     * @param timeouts Тайм-ауты новых подключений
+     * @param parent Родительский объект
+     */
+    worker_listener(MyTcpServer* server, const connection_timeouts& timeouts, QObject* parent = nullptr);
+
+protected:
+    /**
+     * @brief Обработка нового подключения
+     * @param descriptor Дескриптор сокета клиента
+     *
+     * Вызывается в потоке слушателя. Сверх предела подключений клиент
+     * получает сообщение busy, как и в MyTcpServer::slotNewConnection
+     */
+    void incomingConnection(qintptr descriptor) override;
+
+private:
+    MyTcpServer* server;          ///< Сервер, ведущий учёт подключений
+    connection_timeouts timeouts; ///< Тайм-ауты новых подключений
+};
+
+#endif // WORKER_LISTENER_H
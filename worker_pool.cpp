@@ -0,0 +1,87 @@
+#include "../include/worker_pool.h"
+#include <QDebug>
+
+/**
+ * @brief Конструктор пула
+ * @param size Количество потоков (0 - по числу ядер процессора)
+ * @param parent Родительский объект
+ *
+ * Создаёт и запускает потоки с собственными циклами обработки событий
+ */
+worker_pool::worker_pool(int size, QObject* parent) : QObject(parent) {
+    if (size <= 0) {
+        size = qMax(1, QThread::idealThreadCount());
+    }
+
+    for (int i = 0; i < size; i++) {
+        QThread* worker = new QThread(this);
+        worker->setObjectName(QString("io_worker_%1").arg(i));
+        worker->start();
+        workers.push_back(worker);
+        load.push_back(0);
+    }
+}
+
+/**
+ * @brief Деструктор пула
+ */
+worker_pool::~worker_pool() {
+    stop();
+}
+
+/**
+ * @brief Возвращает количество потоков в пуле
+ * @return Размер пула
+ */
+int worker_pool::size() const {
+    return workers.size();
+}
+
+/**
+ * @brief Возвращает поток пула по номеру
+ * @param index Номер потока
+ * @return Поток пула
+ */
+QThread* worker_pool::at(int index) const {
+    return workers[index];
+}
+
+/**
+ * @brief Выбирает поток с наименьшим числом подключений
+ * @return Указатель на выбранный поток
+ */
+QThread* worker_pool::acquire() {
+    int least_loaded = 0;
+    for (int i = 1; i < workers.size(); i++) {
+        if (load[i] < load[least_loaded]) {
+            least_loaded = i;
+        }
+    }
+    load[least_loaded]++;
+    return workers[least_loaded];
+}
+
+/**
+ * @brief Уменьшает счётчик подключений потока
+ * @param worker Поток, в котором было закрыто подключение
+ */
+void worker_pool::release(QThread* worker) {
+    int index = workers.indexOf(worker);
+    if (index >= 0 && load[index] > 0) {
+        load[index]--;
+    }
+}
+
+/**
+ * @brief Останавливает потоки пула
+ *
+ * Завершает циклы обработки событий и дожидается окончания работы потоков
+ */
+void worker_pool::stop() {
+    for (QThread* worker : workers) {
+        worker->quit();
+    }
+    for (QThread* worker : workers) {
+        worker->wait();
+    }
+}
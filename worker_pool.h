@@ -0,0 +1,73 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <QObject>
+#include <QThread>
+#include <QVector>
+
+/**
+ * @brief Пул долгоживущих потоков ввода-вывода
+ *
+ * Каждый поток пула запускает собственный цикл обработки событий.
+ * Объекты клиентов переносятся в наименее загруженный поток вместо
+ * создания отдельного QThread на каждое подключение.
+ *
+ * Все методы вызываются из потока, которому принадлежит пул.
+ */
+class worker_pool : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Конструктор пула
+     * @param size Количество потоков (0 - по числу ядер процессора)
+     * @param parent Родительский объект
+     */
+    explicit worker_pool(int size = 0, QObject* parent = nullptr);
+
+    /**
+     * @brief Деструктор
+     *
+     * Останавливает все потоки пула
+     */
+    ~worker_pool();
+
+    /**
+     * @brief Количество потоков в пуле
+     * @return Размер пула
+     */
+    int size() const;
+
+    /**
+     * @brief Поток пула по номеру
+     * @param index Номер потока от 0 до size() - 1
+     * @return Поток пула
+     */
+    QThread* at(int index) const;
+
+    /**
+     * @brief Выбор наименее загруженного потока
+     * @return Поток, в который следует перенести новое подключение
+     *
+     * Увеличивает счётчик подключений выбранного потока
+     */
+    QThread* acquire();
+
+    /**
+     * @brief Освобождение места в потоке
+     * @param worker Поток, в котором было закрыто подключение
+     */
+    void release(QThread* worker);
+
+    /**
+     * @brief Остановка всех потоков пула с ожиданием завершения
+     */
+    void stop();
+
+private:
+    QVector<QThread*> workers; ///< Потоки пула
+    QVector<int> load;         ///< Количество подключений в каждом потоке
+};
+
+#endif // WORKER_POOL_H